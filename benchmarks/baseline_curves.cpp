@@ -0,0 +1,42 @@
+// Compares the data driven curve with the Hilbert, Morton and snake baselines
+// through CurveEngine::compare on the bundled data: build time (median of 3),
+// locality score, delta entropy and mean step length of every curve.
+//
+// Build and run from the repository root:
+//   g++ -std=c++20 -O2 -Isrc -Ibenchmarks benchmarks/baseline_curves.cpp -o baseline_curves && ./baseline_curves
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "curve_engine.hpp"
+#include "datasets.hpp"
+
+static void report(const char* name, const Image<uint8_t>& img, double ALPHA, int BLOCK_SIZE) {
+  int height = static_cast<int>(img.size()), width = static_cast<int>(img[0].size());
+  CurveEngine engine(height, width, 1);
+  std::printf("%s %dx%d, ALPHA = %.1f, BLOCK_SIZE = %d\n", name, height, width, ALPHA, BLOCK_SIZE);
+  std::printf("  %-11s %12s %10s %15s %10s\n", "curve", "build (ms)", "locality", "delta entropy", "mean step");
+
+  std::vector<std::vector<CurveComparison>> runs;
+  for(int repeat = 0; repeat < 3; ++repeat) {
+    runs.push_back(engine.compare(img, ALPHA, BLOCK_SIZE, "double"));
+  }
+  for(size_t c = 0; c < runs[0].size(); ++c) {
+    std::vector<double> times;
+    for(const auto& run : runs) times.push_back(run[c].build_time_ms);
+    std::sort(times.begin(), times.end());
+    const auto& curve = runs[0][c];
+    std::printf("  %-11s %12.2f %10.3f %15.3f %10.3f\n",
+      curve.name.c_str(), times[1], curve.locality_score, curve.delta_entropy, curve.mean_step_length);
+  }
+}
+
+int main() {
+  report("nucleon center slice", datasets::nucleon_slice(), 0.5, 8);
+  report("frog z=22", datasets::frog_slice(22), 0.5, 8);
+  report("frog 4x4 mosaic", datasets::frog_mosaic(4, 10), 0.5, 8);
+  // A shape that is not a power of two, cropped from the mosaic
+  report("frog 1000x1000 crop", datasets::crop(datasets::frog_mosaic(4, 10), 0, 0, 1000, 1000), 0.5, 8);
+  return 0;
+}
@@ -0,0 +1,67 @@
+// Range-query throughput of CurveIndex over a 1024 x 1024 mosaic of frog
+// slices, with the data driven curve and the Hilbert curve as storage orders.
+// For square queries of several sides it prints the index build time, the
+// queries per second, the mean number of intervals per query (fewer means
+// fewer seeks in the stored data), and the rate of a full scan of the curve.
+//
+// Build and run from the repository root:
+//   g++ -std=c++20 -O2 -Isrc -Ibenchmarks benchmarks/curve_index.cpp -o curve_index && ./curve_index
+
+#include <array>
+#include <cstdio>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "curve_engine.hpp"
+#include "curve_index.hpp"
+#include "datasets.hpp"
+
+using Path = std::vector<std::pair<int, int>>;
+
+static size_t full_scan(const Path& path, const std::array<int, 4>& q) {
+  std::vector<CurveInterval> intervals;
+  for(size_t i = 0, len = path.size(); i < len; ++i) {
+    auto [x, y] = path[i];
+    if(x >= q[0] && x < q[1] && y >= q[2] && y < q[3]) {
+      intervals.push_back({static_cast<int64_t>(i), static_cast<int64_t>(i) + 1});
+    }
+  }
+  CurveIndex::normalize(intervals);
+  return intervals.size();
+}
+
+int main() {
+  std::mt19937 rng(1);
+  int side = 1024;
+  auto img = datasets::frog_mosaic(4, 10);
+  CurveEngine engine(side, side, 1);
+  std::vector<std::pair<const char*, Path>> curves = {
+    {"data driven", engine.build_curve(img, 0.5, 8, "double")},
+    {"hilbert", baseline_curves::hilbert(side, side)}
+  };
+
+  std::printf("frog 4x4 mosaic %dx%d, 2000 random square queries per side\n", side, side);
+  for(int query_side : {16, 64, 256}) {
+    std::vector<std::array<int, 4>> queries;
+    for(int q = 0; q < 2000; ++q) {
+      int row = static_cast<int>(rng() % (side - query_side)), col = static_cast<int>(rng() % (side - query_side));
+      queries.push_back({row, row + query_side, col, col + query_side});
+    }
+    for(const auto& [name, path] : curves) {
+      std::optional<CurveIndex> index;
+      double build_ms = datasets::median_ms([&] { index.emplace(path, side, side); }, 3);
+      size_t intervals = 0;
+      double query_ms = datasets::median_ms([&] {
+        intervals = 0;
+        for(const auto& q : queries) intervals += index->query(q[0], q[1], q[2], q[3]).size();
+      }, 3);
+      double scan_ms = datasets::median_ms([&] {
+        for(int q = 0; q < 20; ++q) full_scan(path, queries[q]);
+      }, 3);
+      std::printf("  side %3d %-11s build %6.1f ms  %9.0f queries/s  %7.1f intervals/query  (full scan %5.0f queries/s)\n",
+        query_side, name, build_ms, 1000 * queries.size() / query_ms, static_cast<double>(intervals) / queries.size(), 1000 * 20 / scan_ms);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,126 @@
+#ifndef BENCHMARK_DATASETS_H
+#define BENCHMARK_DATASETS_H
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "curve_engine.hpp"
+
+/**
+ * @namespace datasets
+ * @brief Loaders for the volumes bundled in images/, shared by the benchmarks.
+ * @details Paths are relative to the repository root, where the benchmarks run.
+ */
+namespace datasets {
+
+inline std::vector<uint8_t> read_raw(const std::string& filename, size_t bytes) {
+  std::ifstream file(filename, std::ios::binary);
+  std::vector<uint8_t> data(std::istreambuf_iterator<char>(file), {});
+  if(data.size() != bytes) {
+    throw std::runtime_error("Could not read " + filename + ", run the benchmarks from the repository root");
+  }
+  return data;
+}
+
+/**
+ * @brief The 256 x 256 x 44 frog volume, stored as z * 65536 + y * 256 + x.
+ */
+inline const std::vector<uint8_t>& frog_volume() {
+  static const auto volume = read_raw("images/frog_256x256x44_uint8.raw", 256 * 256 * 44);
+  return volume;
+}
+
+/**
+ * @brief Slice z of the frog volume, as a 256 x 256 single channel image.
+ */
+inline Image<uint8_t> frog_slice(int z) {
+  const auto& volume = frog_volume();
+  Image<uint8_t> img(256, std::vector<std::vector<uint8_t>>(256, std::vector<uint8_t>(1)));
+  for(int y = 0; y < 256; ++y) {
+    for(int x = 0; x < 256; ++x) {
+      img[y][x][0] = volume[static_cast<size_t>(z % 44) * 65536 + y * 256 + x];
+    }
+  }
+  return img;
+}
+
+/**
+ * @brief tiles x tiles consecutive frog slices from first_slice, laid out row by row.
+ */
+inline Image<uint8_t> frog_mosaic(int tiles, int first_slice) {
+  int side = 256 * tiles;
+  Image<uint8_t> img(side, std::vector<std::vector<uint8_t>>(side, std::vector<uint8_t>(1)));
+  for(int t = 0; t < tiles * tiles; ++t) {
+    auto slice = frog_slice(first_slice + t);
+    for(int y = 0; y < 256; ++y) {
+      for(int x = 0; x < 256; ++x) {
+        img[t / tiles * 256 + y][t % tiles * 256 + x][0] = slice[y][x][0];
+      }
+    }
+  }
+  return img;
+}
+
+/**
+ * @brief The 64 x 64 zero padded center slice of the nucleon volume.
+ */
+inline Image<uint8_t> nucleon_slice() {
+  auto data = read_raw("images/nucleon41x41x41_centerslice_padded.raw", 64 * 64);
+  Image<uint8_t> img(64, std::vector<std::vector<uint8_t>>(64, std::vector<uint8_t>(1)));
+  for(int y = 0; y < 64; ++y) {
+    for(int x = 0; x < 64; ++x) {
+      img[y][x][0] = data[y * 64 + x];
+    }
+  }
+  return img;
+}
+
+/**
+ * @brief The rows x cols window of img starting at (row, col).
+ */
+template<typename T>
+Image<T> crop(const Image<T>& img, int row, int col, int rows, int cols) {
+  Image<T> result(rows);
+  for(int x = 0; x < rows; ++x) {
+    result[x].assign(img[row + x].begin() + col, img[row + x].begin() + col + cols);
+  }
+  return result;
+}
+
+/**
+ * @brief Converts an image to another channel type, e.g. to benchmark float inputs.
+ */
+template<typename To, typename From>
+Image<To> cast(const Image<From>& img) {
+  Image<To> result(img.size(), std::vector<std::vector<To>>(img[0].size(), std::vector<To>(img[0][0].size())));
+  for(size_t x = 0; x < img.size(); ++x) {
+    for(size_t y = 0; y < img[x].size(); ++y) {
+      std::copy(img[x][y].begin(), img[x][y].end(), result[x][y].begin());
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Median wall time of repeats calls of run, in milliseconds.
+ */
+template<typename Run>
+double median_ms(Run&& run, int repeats) {
+  std::vector<double> times;
+  for(int i = 0; i < repeats; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  }
+  std::sort(times.begin(), times.end());
+  return times[times.size() / 2];
+}
+
+}
+
+#endif // !BENCHMARK_DATASETS_H
@@ -0,0 +1,85 @@
+#ifndef BENCHMARK_HEAP_USAGE_H
+#define BENCHMARK_HEAP_USAGE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#include <malloc.h>
+
+/**
+ * @namespace heap_usage
+ * @brief Peak heap footprint of a piece of code, measured by replacing the
+ * global operators new and delete.
+ * @details The replacements are defined here, so this header must be included
+ * by exactly one translation unit, the benchmark's own. Sizes are the usable
+ * sizes reported by glibc, so allocator rounding is included.
+ */
+namespace heap_usage {
+
+inline size_t current = 0, peak = 0;
+
+/**
+ * @brief Peak bytes held by f above the heap usage when it is called.
+ */
+template<typename F>
+size_t peak_bytes(F&& f) {
+  size_t start = current;
+  peak = current;
+  f();
+  return peak - start;
+}
+
+// One out-of-line malloc/free pair behind every form of the operators
+[[gnu::noinline]] inline void* allocate(size_t size, size_t alignment) {
+  size = size == 0 ? 1 : size;
+  void* p = alignment > alignof(std::max_align_t)
+    ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+    : std::malloc(size);
+  if(p != nullptr) {
+    current += malloc_usable_size(p);
+    peak = std::max(peak, current);
+  }
+  return p;
+}
+
+[[gnu::noinline]] inline void release(void* p) {
+  if(p != nullptr) {
+    current -= malloc_usable_size(p);
+    std::free(p);
+  }
+}
+
+inline void* allocate_or_throw(size_t size, size_t alignment) {
+  if(void* p = allocate(size, alignment)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+}
+
+void* operator new(size_t size) { return heap_usage::allocate_or_throw(size, 0); }
+void* operator new[](size_t size) { return heap_usage::allocate_or_throw(size, 0); }
+void* operator new(size_t size, std::align_val_t a) { return heap_usage::allocate_or_throw(size, static_cast<size_t>(a)); }
+void* operator new[](size_t size, std::align_val_t a) { return heap_usage::allocate_or_throw(size, static_cast<size_t>(a)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return heap_usage::allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return heap_usage::allocate(size, 0); }
+void* operator new(size_t size, std::align_val_t a, const std::nothrow_t&) noexcept { return heap_usage::allocate(size, static_cast<size_t>(a)); }
+void* operator new[](size_t size, std::align_val_t a, const std::nothrow_t&) noexcept { return heap_usage::allocate(size, static_cast<size_t>(a)); }
+
+void operator delete(void* p) noexcept { heap_usage::release(p); }
+void operator delete[](void* p) noexcept { heap_usage::release(p); }
+void operator delete(void* p, size_t) noexcept { heap_usage::release(p); }
+void operator delete[](void* p, size_t) noexcept { heap_usage::release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { heap_usage::release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { heap_usage::release(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { heap_usage::release(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { heap_usage::release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { heap_usage::release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { heap_usage::release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { heap_usage::release(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { heap_usage::release(p); }
+
+#endif // !BENCHMARK_HEAP_USAGE_H
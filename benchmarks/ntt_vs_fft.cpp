@@ -0,0 +1,50 @@
+// Compares the exact integer circular correlation (three-prime NTT) with the
+// floating point FFT one on random 16-bit signals, and counts the shifts where
+// the rounded FFT result differs from the exact one.
+//
+// Build and run from the repository root:
+//   g++ -std=c++20 -O2 -Isrc benchmarks/ntt_vs_fft.cpp -o ntt_vs_fft && ./ntt_vs_fft
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "convolutions.hpp"
+
+template<typename F>
+static double median_ms(F&& run, int repeats) {
+  std::vector<double> times;
+  for(int i = 0; i < repeats; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+  }
+  std::sort(times.begin(), times.end());
+  return times[times.size() / 2];
+}
+
+int main() {
+  std::mt19937 rng(9);
+  std::printf("%10s %12s %12s %8s %12s\n", "N", "ntt (ms)", "fft (ms)", "speedup", "misrounded");
+  for(int n : {1 << 12, 1 << 16, 1 << 20, 3000000}) {
+    std::vector<int32_t> a(n), b(n);
+    for(auto& v : a) v = static_cast<int32_t>(rng() % 65536);
+    for(auto& v : b) v = static_cast<int32_t>(rng() % 65536);
+    std::vector<double> fa(a.begin(), a.end()), fb(b.begin(), b.end());
+
+    std::vector<int64_t> exact;
+    std::vector<double> approximate;
+    int repeats = n > (1 << 20) ? 3 : 5;
+    double ntt_ms = median_ms([&] { exact = convolutions::correlate_circular(a.data(), b.data(), n); }, repeats);
+    double fft_ms = median_ms([&] { approximate = convolutions::correlate_circular(fa.data(), fb.data(), n); }, repeats);
+
+    long long misrounded = 0;
+    for(int s = 0; s < n; ++s) misrounded += std::llround(approximate[s]) != exact[s];
+    std::printf("%10d %12.1f %12.1f %7.2fx %11.1f%%\n", n, ntt_ms, fft_ms, fft_ms / ntt_ms, 100.0 * misrounded / n);
+  }
+  return 0;
+}
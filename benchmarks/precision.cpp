@@ -0,0 +1,99 @@
+// Compares precision = "double", "float" and "integer" on the bundled frog
+// volume: build_curve on a slice and a mosaic of slices, and build_curves on an
+// animation of consecutive slices (cropped to 64 x 64 for the quadratic L1-norm
+// alignment). Every row reports the median time, the peak heap footprint in
+// bytes per pixel (see heap_usage.hpp) of a cold call, which constructs its
+// engine, and of a warm call on an engine that already reserved its
+// workspaces, and whether the result matches "double". The float32 copies of the same data
+// show the float alignment path, which integral inputs never take.
+//
+// Memory bandwidth is not reported: it needs hardware counters, so measure it
+// outside the process, e.g. with perf stat -e cache-misses,LLC-load-misses.
+//
+// Build and run from the repository root:
+//   g++ -std=c++20 -O2 -Isrc -Ibenchmarks benchmarks/precision.cpp -o precision && ./precision
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "curve_engine.hpp"
+#include "datasets.hpp"
+#include "heap_usage.hpp"
+
+template<typename T>
+static void bench_curve(const char* name, const Image<T>& img, double ALPHA, int BLOCK_SIZE) {
+  CurveEngine engine(static_cast<int>(img.size()), static_cast<int>(img[0].size()), static_cast<int>(img[0][0].size()));
+  std::vector<std::string> precisions = {"double", "float"};
+  if constexpr (std::is_integral_v<T>) precisions.push_back("integer");
+
+  std::vector<std::pair<int, int>> reference;
+  double reference_ms = 0;
+  for(const auto& precision : precisions) {
+    std::vector<std::pair<int, int>> path;
+    double ms = datasets::median_ms([&] { path = engine.build_curve(img, ALPHA, BLOCK_SIZE, precision); }, 3);
+    double cold = static_cast<double>(heap_usage::peak_bytes([&] {
+      CurveEngine(static_cast<int>(img.size()), static_cast<int>(img[0].size()), static_cast<int>(img[0][0].size())).build_curve(img, ALPHA, BLOCK_SIZE, precision);
+    }));
+    double warm = static_cast<double>(heap_usage::peak_bytes([&] { engine.build_curve(img, ALPHA, BLOCK_SIZE, precision); }));
+    double pixels = static_cast<double>(path.size());
+    if(precision == "double") {
+      reference = path;
+      reference_ms = ms;
+    }
+    std::printf("  %-30s %-8s %9.1f ms  x%.2f  cold %6.1f B/px  warm %6.1f B/px  same path as double: %s\n",
+      name, precision.c_str(), ms, reference_ms / ms, cold / pixels, warm / pixels, path == reference ? "yes" : "no");
+  }
+}
+
+template<typename T>
+static void bench_animation(const char* name, const std::vector<Image<T>>& frames, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy) {
+  CurveEngine engine(static_cast<int>(frames[0].size()), static_cast<int>(frames[0][0].size()), 1);
+  std::vector<std::vector<std::pair<int, int>>> reference;
+  double reference_ms = 0;
+  for(std::string precision : {"double", "float"}) {
+    std::vector<std::vector<std::pair<int, int>>> paths;
+    double ms = datasets::median_ms([&] { paths = engine.build_curves(frames, ALPHA, BLOCK_SIZE, align_strategy, precision); }, 3);
+    double cold = static_cast<double>(heap_usage::peak_bytes([&] {
+      CurveEngine(static_cast<int>(frames[0].size()), static_cast<int>(frames[0][0].size()), 1).build_curves(frames, ALPHA, BLOCK_SIZE, align_strategy, precision);
+    }));
+    double warm = static_cast<double>(heap_usage::peak_bytes([&] { engine.build_curves(frames, ALPHA, BLOCK_SIZE, align_strategy, precision); }));
+    double pixels = static_cast<double>(frames.size() * frames[0].size() * frames[0][0].size());
+    if(precision == "double") {
+      reference = paths;
+      reference_ms = ms;
+    }
+    std::printf("  %-30s %-8s %9.1f ms  x%.2f  cold %6.1f B/px  warm %6.1f B/px  same curves as double: %s\n",
+      name, precision.c_str(), ms, reference_ms / ms, cold / pixels, warm / pixels, paths == reference ? "yes" : "no");
+  }
+}
+
+int main() {
+  double ALPHA = 0.5;
+  int BLOCK_SIZE = 8;
+
+  std::printf("build_curve, ALPHA = %.1f, BLOCK_SIZE = %d\n", ALPHA, BLOCK_SIZE);
+  auto slice = datasets::frog_slice(22);
+  auto mosaic = datasets::frog_mosaic(2, 10);
+  bench_curve("frog z=22 256x256 uint8", slice, ALPHA, BLOCK_SIZE);
+  bench_curve("frog z=22 256x256 float32", datasets::cast<float>(slice), ALPHA, BLOCK_SIZE);
+  bench_curve("frog 2x2 mosaic 512x512 uint8", mosaic, ALPHA, BLOCK_SIZE);
+  bench_curve("frog 2x2 mosaic 512x512 f32", datasets::cast<float>(mosaic), ALPHA, BLOCK_SIZE);
+
+  std::printf("build_curves, 16 consecutive frog slices\n");
+  std::vector<Image<uint8_t>> frames, crops;
+  for(int z = 14; z < 30; ++z) {
+    frames.push_back(datasets::frog_slice(z));
+    crops.push_back(datasets::crop(frames.back(), 96, 96, 64, 64));
+  }
+  std::vector<Image<float>> float_frames, float_crops;
+  for(size_t f = 0; f < frames.size(); ++f) {
+    float_frames.push_back(datasets::cast<float>(frames[f]));
+    float_crops.push_back(datasets::cast<float>(crops[f]));
+  }
+  bench_animation("uint8 64x64 L1-norm", crops, ALPHA, BLOCK_SIZE, "L1-norm");
+  bench_animation("float32 64x64 L1-norm", float_crops, ALPHA, BLOCK_SIZE, "L1-norm");
+  bench_animation("uint8 256x256 L2-norm", frames, ALPHA, BLOCK_SIZE, "L2-norm");
+  bench_animation("float32 256x256 L2-norm", float_frames, ALPHA, BLOCK_SIZE, "L2-norm");
+  return 0;
+}
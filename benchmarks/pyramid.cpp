@@ -0,0 +1,52 @@
+// Quality against time of the coarse-to-fine construction: for every number
+// of pyramid levels, the best of 3 build_curve_pyramid times and the
+// metrics::locality_score of the curve (lower is better), relative to
+// levels = 0, which is plain Prim.
+// levels = 0 is also checked against build_curve.
+//
+// Build and run from the repository root:
+//   g++ -std=c++20 -O2 -Isrc -Ibenchmarks benchmarks/pyramid.cpp -o pyramid && ./pyramid
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include "curve_engine.hpp"
+#include "datasets.hpp"
+
+static int report(const char* name, const Image<uint8_t>& img, double ALPHA, int BLOCK_SIZE) {
+  int height = static_cast<int>(img.size()), width = static_cast<int>(img[0].size());
+  CurveEngine engine(height, width, 1);
+  std::printf("%s %dx%d, ALPHA = %.1f, BLOCK_SIZE = %d\n", name, height, width, ALPHA, BLOCK_SIZE);
+
+  int failures = 0;
+  double base_ms = 0, base_locality = 0;
+  for(int levels = 0; levels <= 5; ++levels) {
+    std::vector<std::pair<int, int>> path;
+    double best_ms = std::numeric_limits<double>::max();
+    for(int repeat = 0; repeat < 3; ++repeat) {
+      best_ms = std::min(best_ms, datasets::median_ms([&] { path = engine.build_curve_pyramid(img, ALPHA, BLOCK_SIZE, levels); }, 1));
+    }
+    double locality = metrics::locality_score(img, path);
+    if(levels == 0) {
+      base_ms = best_ms;
+      base_locality = locality;
+      if(path != engine.build_curve(img, ALPHA, BLOCK_SIZE, "double")) {
+        std::printf("  FAIL levels = 0 differs from build_curve\n");
+        failures += 1;
+      }
+    }
+    std::printf("  levels = %d %9.1f ms (x%.2f)  locality %.3f (%+.1f%%)\n",
+      levels, best_ms, base_ms / best_ms, locality, 100 * (locality - base_locality) / base_locality);
+  }
+  return failures;
+}
+
+int main() {
+  int failures = 0;
+  failures += report("nucleon center slice", datasets::nucleon_slice(), 0.5, 8);
+  failures += report("frog z=22", datasets::frog_slice(22), 0.5, 8);
+  failures += report("frog 6x6 mosaic", datasets::frog_mosaic(6, 4), 0.5, 8);
+  return failures == 0 ? 0 : 1;
+}
@@ -6,7 +6,8 @@ cpp_module = Extension(
     'data_driven_module',
     sources=['src/data_driven_space_filling_curve.cpp'],
     include_dirs=[pybind11.get_include()],
-    extra_compile_args = ["-std=c++20"],
+    extra_compile_args = ["-std=c++20", "-pthread"],
+    extra_link_args = ["-pthread"],
     language='c++'
 )
 
@@ -0,0 +1,136 @@
+#ifndef BASELINE_CURVES_H
+#define BASELINE_CURVES_H
+
+#include <vector>
+#include <utility>
+#include <cstdlib>
+
+/**
+ * @namespace baseline_curves
+ * @brief A namespace with the classic, image independent space-filling curves
+ * used as baselines for the data driven curve.
+ *
+ * Every generator returns the (row, col) pixels of a height x width grid in
+ * traversal order, like Prim::run, and supports any shape.
+ */
+namespace baseline_curves {
+
+/**
+ * @brief Boustrophedon order: even rows left to right, odd rows right to left.
+ */
+inline std::vector<std::pair<int, int>> snake(int height, int width) {
+  std::vector<std::pair<int, int>> path;
+  path.reserve(static_cast<size_t>(height) * width);
+  for(int x = 0; x < height; ++x) {
+    for(int i = 0; i < width; ++i) {
+      path.emplace_back(x, x % 2 == 0 ? i : width - 1 - i);
+    }
+  }
+  return path;
+}
+
+inline void morton_visit(int x, int y, int size, int height, int width, std::vector<std::pair<int, int>>& path) {
+  if(x >= height || y >= width) {
+    return;
+  }
+  if(size == 1) {
+    path.emplace_back(x, y);
+    return;
+  }
+  int half = size / 2;
+  morton_visit(x, y, half, height, width, path);
+  morton_visit(x, y + half, half, height, width, path);
+  morton_visit(x + half, y, half, height, width, path);
+  morton_visit(x + half, y + half, half, height, width, path);
+}
+
+/**
+ * @brief Z-order (Morton) curve, columns vary fastest inside every 2 x 2 block.
+ * @details Other shapes take the Z-order of the enclosing power of two square
+ * and skip the pixels outside the grid, so the curve jumps across the gaps.
+ */
+inline std::vector<std::pair<int, int>> morton(int height, int width) {
+  std::vector<std::pair<int, int>> path;
+  path.reserve(static_cast<size_t>(height) * width);
+  int size = 1;
+  while(size < height || size < width) {
+    size *= 2;
+  }
+  if(height > 0 && width > 0) {
+    morton_visit(0, 0, size, height, width, path);
+  }
+  return path;
+}
+
+inline int sign(int v) {
+  return (v > 0) - (v < 0);
+}
+
+inline int floor_half(int v) {
+  return v >= 0 ? v / 2 : -((-v + 1) / 2);
+}
+
+/**
+ * @brief Fills the rectangle spanned from (x, y) by the major axis (ax, ay)
+ * and the minor axis (bx, by), in the generalized Hilbert order.
+ */
+inline void hilbert_visit(int x, int y, int ax, int ay, int bx, int by, std::vector<std::pair<int, int>>& path) {
+  int w = std::abs(ax + ay), h = std::abs(bx + by);
+  int dax = sign(ax), day = sign(ay), dbx = sign(bx), dby = sign(by);
+
+  if(h == 1) {
+    for(int i = 0; i < w; ++i, x += dax, y += day) path.emplace_back(x, y);
+    return;
+  }
+  if(w == 1) {
+    for(int i = 0; i < h; ++i, x += dbx, y += dby) path.emplace_back(x, y);
+    return;
+  }
+
+  int ax2 = floor_half(ax), ay2 = floor_half(ay), bx2 = floor_half(bx), by2 = floor_half(by);
+  int w2 = std::abs(ax2 + ay2), h2 = std::abs(bx2 + by2);
+  if(2 * w > 3 * h) {
+    // Long rectangle, split it in two along the major axis
+    if(w2 % 2 != 0 && w > 2) {
+      ax2 += dax;
+      ay2 += day;
+    }
+    hilbert_visit(x, y, ax2, ay2, bx, by, path);
+    hilbert_visit(x + ax2, y + ay2, ax - ax2, ay - ay2, bx, by, path);
+  } else {
+    // Split in three: up the minor axis, along the major axis, and back down
+    if(h2 % 2 != 0 && h > 2) {
+      bx2 += dbx;
+      by2 += dby;
+    }
+    hilbert_visit(x, y, bx2, by2, ax2, ay2, path);
+    hilbert_visit(x + bx2, y + by2, ax, ay, bx - bx2, by - by2, path);
+    hilbert_visit(x + (ax - dax) + (bx2 - dbx), y + (ay - day) + (by2 - dby), -bx2, -by2, -(ax - ax2), -(ay - ay2), path);
+  }
+}
+
+/**
+ * @brief Hilbert curve, generalized to any shape.
+ * @details On power of two squares it is the classic Hilbert curve. Other shapes
+ * are split recursively into sub-rectangles with even sides where possible
+ * (the "gilbert" construction by J. Cerveny), so every step moves to a
+ * 4-neighbour except for at most one diagonal step when the shape forces it.
+ */
+inline std::vector<std::pair<int, int>> hilbert(int height, int width) {
+  std::vector<std::pair<int, int>> path;
+  path.reserve(static_cast<size_t>(height) * width);
+  if(height <= 0 || width <= 0) {
+    return path;
+  }
+  // The major axis follows the longer side, coordinates are (row, col)
+  if(width >= height) {
+    hilbert_visit(0, 0, 0, width, height, 0, path);
+  } else {
+    hilbert_visit(0, 0, height, 0, 0, width, path);
+  }
+  return path;
+}
+
+}
+
+#endif // !BASELINE_CURVES_H
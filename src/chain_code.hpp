@@ -0,0 +1,338 @@
+#ifndef CHAIN_CODE_H
+#define CHAIN_CODE_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <stdexcept>
+
+// POSIX memory mapping for MappedChainCode
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "util.hpp"
+
+/**
+ * @namespace chain_code
+ * @brief A namespace with a compact serialization of traversal paths.
+ *
+ * Every step of a curve moves to a 4-neighbour, so a path is stored as its
+ * start pixel followed by one 2-bit direction (an index of util::DIR_X/DIR_Y)
+ * per step. The pixel at every checkpoint_interval-th position is also stored,
+ * so any position can be decoded without reading the steps before it.
+ *
+ * Layout, all little-endian:
+ *  - Header (40 bytes).
+ *  - ceil(length / checkpoint_interval) checkpoints, (row, col) int32 pairs.
+ *  - ceil((length - 1) / 4) bytes of steps, step i goes from pixel i to pixel
+ *    i + 1 and is stored in bits 2 * (i % 4) of byte i / 4.
+ *
+ * The layout has no pointers, so a file can be memory mapped and read in place.
+ */
+namespace chain_code {
+
+inline constexpr uint32_t MAGIC = 0x48434653; // "SFCH"
+inline constexpr uint32_t VERSION = 1;
+inline constexpr uint32_t DEFAULT_CHECKPOINT_INTERVAL = 4096;
+
+enum Orientation : uint32_t {
+  CLOCKWISE = 0,        // As displayed, with rows growing downwards
+  COUNTER_CLOCKWISE = 1
+};
+
+struct Header {
+  uint32_t magic, version;
+  int32_t height, width;
+  int32_t start_row, start_col;
+  uint32_t orientation;         // Winding of the closed curve, see Orientation
+  uint32_t checkpoint_interval; // Steps between checkpoints, a multiple of 4
+  uint64_t length;              // Number of pixels
+};
+static_assert(sizeof(Header) == 40);
+
+inline size_t checkpoint_count(uint64_t length, uint32_t checkpoint_interval) {
+  return static_cast<size_t>((length + checkpoint_interval - 1) / checkpoint_interval);
+}
+
+inline size_t step_bytes(uint64_t length) {
+  return length < 2 ? 0 : static_cast<size_t>((length - 1 + 3) / 4);
+}
+
+/**
+ * @brief Total size in bytes of an encoded path.
+ */
+inline size_t encoded_size(uint64_t length, uint32_t checkpoint_interval) {
+  return sizeof(Header) + checkpoint_count(length, checkpoint_interval) * 2 * sizeof(int32_t) + step_bytes(length);
+}
+
+/**
+ * @brief Incremental encoder, fed one step at a time by a path walk.
+ */
+class Encoder {
+public:
+  /**
+   * @param height, width Shape of the traversed image.
+   * @param start First pixel of the path.
+   * @param length Number of pixels of the path, known in advance to size the buffer.
+   * @param checkpoint_interval Steps between checkpoints, a positive multiple of 4.
+   */
+  Encoder(int height, int width, std::pair<int, int> start, uint64_t length, uint32_t checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL) :
+    start { start },
+    current { start },
+    length { length },
+    checkpoint_interval { checkpoint_interval }
+  {
+    if(checkpoint_interval == 0 || checkpoint_interval % 4 != 0) {
+      throw std::runtime_error(std::format("Checkpoint interval must be a positive multiple of 4, found = {}", checkpoint_interval));
+    }
+    if(length == 0) {
+      throw std::runtime_error("Cannot encode an empty path");
+    }
+    data.assign(encoded_size(length, checkpoint_interval), 0);
+    Header header{MAGIC, VERSION, height, width, start.first, start.second, CLOCKWISE, checkpoint_interval, length};
+    std::memcpy(data.data(), &header, sizeof(Header));
+    steps_offset = sizeof(Header) + checkpoint_count(length, checkpoint_interval) * 2 * sizeof(int32_t);
+    write_checkpoint(0);
+  }
+
+  /**
+   * @brief Appends the step from the current pixel towards util direction i.
+   */
+  void push(int direction) {
+    if(index + 1 >= length) {
+      throw std::runtime_error(std::format("Path is longer than the declared length = {}", length));
+    }
+    std::pair<int, int> next = {current.first + util::DIR_X[direction], current.second + util::DIR_Y[direction]};
+    data[steps_offset + index / 4] |= static_cast<uint8_t>(direction << (2 * (index % 4)));
+    area += static_cast<int64_t>(current.first) * next.second - static_cast<int64_t>(next.first) * current.second;
+    current = next;
+    index += 1;
+    if(index % checkpoint_interval == 0) {
+      write_checkpoint(index / checkpoint_interval);
+    }
+  }
+
+  /**
+   * @brief Closes the curve and returns the encoded bytes.
+   */
+  std::vector<uint8_t> finish() {
+    if(index + 1 != length) {
+      throw std::runtime_error(std::format("Path has {} pixels, but {} were declared", index + 1, length));
+    }
+    // Closing step back to the start, then the sign of the shoelace sum
+    area += static_cast<int64_t>(current.first) * start.second - static_cast<int64_t>(start.first) * current.second;
+    uint32_t orientation = area > 0 ? COUNTER_CLOCKWISE : CLOCKWISE;
+    std::memcpy(data.data() + offsetof(Header, orientation), &orientation, sizeof(orientation));
+    return std::move(data);
+  }
+
+private:
+  std::pair<int, int> start, current;
+  uint64_t length, index = 0;
+  uint32_t checkpoint_interval;
+  size_t steps_offset;
+  int64_t area = 0;
+  std::vector<uint8_t> data;
+
+  void write_checkpoint(uint64_t k) {
+    int32_t pixel[2] = {current.first, current.second};
+    std::memcpy(data.data() + sizeof(Header) + k * sizeof(pixel), pixel, sizeof(pixel));
+  }
+};
+
+/**
+ * @brief Encodes a path whose consecutive pixels are 4-neighbours.
+ */
+inline std::vector<uint8_t> encode(const std::vector<std::pair<int, int>>& path, int height, int width, uint32_t checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL) {
+  if(path.empty()) {
+    throw std::runtime_error("Cannot encode an empty path");
+  }
+  Encoder encoder(height, width, path[0], path.size(), checkpoint_interval);
+  for(size_t i = 1, len = path.size(); i < len; ++i) {
+    int direction = util::get_direction(path[i - 1], path[i]);
+    if(direction == -1) {
+      throw std::runtime_error(std::format(
+        "Pixels ({}, {}) and ({}, {}) at position {} are not 4-neighbours",
+        path[i - 1].first, path[i - 1].second, path[i].first, path[i].second, i
+      ));
+    }
+    encoder.push(direction);
+  }
+  return encoder.finish();
+}
+
+/**
+ * @brief Read-only view over an encoded path, e.g. a memory mapped file.
+ * @details The bytes are not copied, so they must outlive the view.
+ */
+class View {
+public:
+  View(const void* data, size_t bytes) : bytes { static_cast<const uint8_t*>(data) } {
+    if(bytes < sizeof(Header)) {
+      throw std::runtime_error("Chain code is truncated: missing header");
+    }
+    std::memcpy(&header, this->bytes, sizeof(Header));
+    if(header.magic != MAGIC || header.version != VERSION) {
+      throw std::runtime_error(std::format("Not a version {} chain code", VERSION));
+    }
+    if(header.length == 0 || header.checkpoint_interval == 0 || header.checkpoint_interval % 4 != 0) {
+      throw std::runtime_error("Chain code header is corrupted");
+    }
+    // Every byte holds at most 4 steps, so this bounds length before encoded_size can overflow
+    if(header.length - 1 > static_cast<uint64_t>(bytes - sizeof(Header)) * 4) {
+      throw std::runtime_error(std::format("Chain code is truncated: {} pixels do not fit in {} bytes", header.length, bytes));
+    }
+    if(bytes < encoded_size(header.length, header.checkpoint_interval)) {
+      throw std::runtime_error(std::format(
+        "Chain code is truncated: expected {} bytes, found {}",
+        encoded_size(header.length, header.checkpoint_interval), bytes
+      ));
+    }
+    steps = this->bytes + sizeof(Header) + checkpoint_count(header.length, header.checkpoint_interval) * 2 * sizeof(int32_t);
+  }
+
+  const Header& get_header() const { return header; }
+  size_t size() const { return static_cast<size_t>(header.length); }
+
+  /**
+   * @brief Pixel at position i, decoded from the closest checkpoint before it.
+   */
+  std::pair<int, int> at(size_t i) const {
+    if(i >= size()) {
+      throw std::out_of_range(std::format("Position {} is out of a path of {} pixels", i, size()));
+    }
+    size_t base = i / header.checkpoint_interval * header.checkpoint_interval;
+    auto pixel = checkpoint(base / header.checkpoint_interval);
+    for(size_t s = base; s < i; ++s) {
+      int direction = step(s);
+      pixel.first += util::DIR_X[direction];
+      pixel.second += util::DIR_Y[direction];
+    }
+    return pixel;
+  }
+
+  /**
+   * @brief Pixels at positions [begin, end).
+   */
+  std::vector<std::pair<int, int>> decode(size_t begin, size_t end) const {
+    end = std::min(end, size());
+    std::vector<std::pair<int, int>> path;
+    if(begin >= end) {
+      return path;
+    }
+    path.reserve(end - begin);
+    auto pixel = at(begin);
+    path.emplace_back(pixel);
+    for(size_t s = begin; s + 1 < end; ++s) {
+      int direction = step(s);
+      pixel.first += util::DIR_X[direction];
+      pixel.second += util::DIR_Y[direction];
+      path.emplace_back(pixel);
+    }
+    return path;
+  }
+
+  std::vector<std::pair<int, int>> decode() const {
+    return decode(0, size());
+  }
+
+private:
+  const uint8_t* bytes;
+  const uint8_t* steps;
+  Header header;
+
+  int step(size_t s) const {
+    return steps[s / 4] >> (2 * (s % 4)) & 3;
+  }
+
+  std::pair<int, int> checkpoint(size_t k) const {
+    int32_t pixel[2];
+    std::memcpy(pixel, bytes + sizeof(Header) + k * sizeof(pixel), sizeof(pixel));
+    return {pixel[0], pixel[1]};
+  }
+};
+
+inline std::vector<std::pair<int, int>> decode(const void* data, size_t bytes) {
+  return View(data, bytes).decode();
+}
+
+/**
+ * @brief Encoded path stored in a file and read through a memory mapping.
+ */
+class MappedChainCode {
+public:
+  explicit MappedChainCode(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+      throw std::runtime_error(std::format("Could not open chain code file {}", filename));
+    }
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || st.st_size == 0) {
+      ::close(fd);
+      throw std::runtime_error(std::format("Could not read chain code file {}", filename));
+    }
+    bytes = static_cast<size_t>(st.st_size);
+    mapped = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if(mapped == MAP_FAILED) {
+      throw std::runtime_error(std::format("Could not map chain code file {}", filename));
+    }
+    try {
+      view.emplace(mapped, bytes);
+    } catch(...) {
+      ::munmap(mapped, bytes);
+      throw;
+    }
+  }
+
+  MappedChainCode(const MappedChainCode&) = delete;
+  MappedChainCode& operator=(const MappedChainCode&) = delete;
+
+  ~MappedChainCode() {
+    ::munmap(mapped, bytes);
+  }
+
+  const View& get_view() const { return *view; }
+
+private:
+  void* mapped;
+  size_t bytes;
+  std::optional<View> view;
+};
+
+/**
+ * @brief Writes an encoded path to a file, through a uniquely named temporary file and a rename.
+ */
+inline void write_file(const std::string& filename, const std::vector<uint8_t>& data) {
+  std::string temporary = filename + ".XXXXXX";
+  int fd = ::mkstemp(temporary.data());
+  FILE* file = fd < 0 ? nullptr : ::fdopen(fd, "wb");
+  if(file == nullptr) {
+    if(fd >= 0) {
+      ::close(fd);
+      std::remove(temporary.c_str());
+    }
+    throw std::runtime_error(std::format("Could not write chain code file {}", filename));
+  }
+  ::fchmod(fd, 0644);
+  bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+  ok = std::fclose(file) == 0 && ok;
+  if(!ok || std::rename(temporary.c_str(), filename.c_str()) != 0) {
+    std::remove(temporary.c_str());
+    throw std::runtime_error(std::format("Could not write chain code file {}", filename));
+  }
+}
+
+}
+
+#endif // !CHAIN_CODE_H
@@ -7,6 +7,11 @@
 #include <cmath>
 #include <string>
 #include <complex>
+#include <cstdint>
+#include <type_traits>
+#include <array>
+#include <bit>
+#include <unordered_map>
 /**
  * @namespace convolutions
  * @brief A namespace containing methods related to fft convolutions
@@ -15,60 +20,325 @@
  */
 namespace convolutions {
 
+/**
+ * @brief Type of the correlation terms for inputs of type F: exact int64 sums
+ * for integral inputs, F itself for floating inputs.
+ */
+template<typename F>
+using accumulator_t = std::conditional_t<std::is_integral_v<F>, int64_t, F>;
+
 // Special thanks to https://github.com/kth-competitive-programming/kactl/blob/main/content/numerical/FastFourierTransform.h
-using Complex = std::complex<double>;
-void fft(std::vector<Complex>& a) {
-  std::vector<std::complex<long double>> R(2, 1); 
-  std::vector<Complex> rt(2, 1); // (^ 10% faster if double)
-  int n = (int)a.size(), L = 31 - __builtin_clz(n);
-  for(int k = 2; k < n; k *= 2) {
-    R.resize(n);
-    rt.resize(n);
-    auto x = std::polar(1.0L, std::acos(-1.0L) / k);
-    for (int i = k; i < 2 * k; ++i) {
-      rt[i] = R[i] = i & 1 ? R[i / 2] * x : R[i / 2];
+// The transforms are templated on the floating type F (float or double). Twiddles are
+// computed in long double once per size, rounded to F and cached, see fft_tables.
+template<typename F>
+using Complex = std::complex<F>;
+
+/**
+ * @brief Twiddles and bit-reversal permutation of a size n transform.
+ */
+template<typename F>
+struct FftTables {
+  std::vector<Complex<F>> rt;
+  std::vector<int> rev;
+};
+
+/**
+ * @brief Tables of a size n transform, built on first use and then shared by
+ * every transform of the same size and type on the same thread.
+ * @details Only the F-typed twiddles are kept, the long double recurrence
+ * that produces them is dropped once they are built.
+ */
+template<typename F>
+const FftTables<F>& fft_tables(int n) {
+  thread_local std::unordered_map<int, FftTables<F>> cache;
+  auto [it, inserted] = cache.try_emplace(n);
+  if (inserted) {
+    auto& tables = it->second;
+    std::vector<std::complex<long double>> R(std::max(n, 2), 1);
+    tables.rt.assign(std::max(n, 2), 1); // (^ 10% faster if double)
+    for(int k = 2; k < n; k *= 2) {
+      auto x = std::polar(1.0L, std::acos(-1.0L) / k);
+      for (int i = k; i < 2 * k; ++i) {
+        tables.rt[i] = R[i] = i & 1 ? R[i / 2] * x : R[i / 2];
+      }
+    }
+    int L = 31 - __builtin_clz(n);
+    tables.rev.assign(n, 0);
+    for(int i = 0; i < n; ++i) {
+      tables.rev[i] = (tables.rev[i / 2] | (i & 1) << L) / 2;
     }
   }
-  std::vector<int> rev(n);
+  return it->second;
+}
+
+template<typename F>
+void fft(std::vector<Complex<F>>& a) {
+  int n = (int)a.size();
+  const auto& [rt, rev] = fft_tables<F>(n);
   for(int i = 0; i < n; ++i) {
-    rev[i] = (rev[i / 2] | (i & 1) << L) / 2;
     if (i < rev[i]) swap(a[i], a[rev[i]]);
   }
   for (int k = 1; k < n; k *= 2)
     for (int i = 0; i < n; i += 2 * k)
       for (int j = 0; j < k; ++j) {
         // Complex z = rt[j+k] * a[i+j+k]; // (25% faster if hand-rolled)  /// include-line
-        auto x = (double *)&rt[j+k], y = (double *)&a[i+j+k];              /// exclude-line
-        Complex z(x[0]*y[0] - x[1]*y[1], x[0]*y[1] + x[1]*y[0]);           /// exclude-line
+        auto x = (const F *)&rt[j+k], y = (F *)&a[i+j+k];                  /// exclude-line
+        Complex<F> z(x[0]*y[0] - x[1]*y[1], x[0]*y[1] + x[1]*y[0]);        /// exclude-line
         a[i + j + k] = a[i + j] - z;
         a[i + j] += z;
       }
 }
 
-std::vector<double> convolution(const std::vector<double>& a, const std::vector<double>& b) {
-  if (a.empty() || b.empty()) return {};
-  std::vector<double> res((int)a.size() + (int)b.size() - 1);
-  int L = 32 - __builtin_clz((int)res.size()), n = 1 << L;
-  std::vector<Complex> in(n), out(n);
-  copy(a.begin(), a.end(), in.begin());
-  for (int i = 0; i < (int)b.size(); ++i) in[i].imag(b[i]);
+/**
+ * @brief Finishes a convolution whose inputs are packed as in[i] = a[i] + i * b[i].
+ * @details Returns the terms [offset, offset + count) of a * b. in is overwritten,
+ * and is also the buffer of the second transform.
+ */
+template<typename F>
+std::vector<F> convolve_packed(std::vector<Complex<F>>& in, int offset, int count) {
+  int n = (int)in.size();
   fft(in);
-  for (Complex& x: in)  x *= x;
-  for (int i = 0; i < n; ++i) out[i] = in[-i & (n - 1)] - conj(in[i]);
-  fft(out);
-  for (int i = 0; i < (int)res.size(); ++i) {
-    res[i] = imag(out[i]) / (4 * n);
+  for (Complex<F>& x: in)  x *= x;
+  // out[i] = in[-i] - conj(in[i]), computed in place for each pair (i, -i)
+  for (int i = 0; i <= n / 2; ++i) {
+    int j = -i & (n - 1);
+    Complex<F> x = in[i], y = in[j];
+    in[i] = y - conj(x);
+    in[j] = x - conj(y);
+  }
+  fft(in);
+  std::vector<F> res(count);
+  for (int i = 0; i < count; ++i) {
+    res[i] = imag(in[offset + i]) / static_cast<F>(4 * n);
   }
   return res;
 }
 
-std::vector<double> correlate_valid(const std::vector<double>& a, std::vector<double> b) {
+template<typename F>
+std::vector<F> convolution(const std::vector<F>& a, const std::vector<F>& b) {
+  if (a.empty() || b.empty()) return {};
+  int res_size = (int)a.size() + (int)b.size() - 1;
+  int L = 32 - __builtin_clz(res_size), n = 1 << L;
+  std::vector<Complex<F>> in(n);
+  copy(a.begin(), a.end(), in.begin());
+  for (int i = 0; i < (int)b.size(); ++i) in[i].imag(b[i]);
+  return convolve_packed(in, 0, res_size);
+}
+
+template<typename F>
+std::vector<F> correlate_valid(const std::vector<F>& a, std::vector<F> b) {
   if (a.empty() || b.empty()) return {};
   int sz_a = (int)a.size(), sz_b = (int)b.size();
   if(sz_a < sz_b) return {};
   reverse(begin(b), end(b));
   auto full = convolution(a, b);
-  return std::vector<double>(begin(full) + sz_b - 1, begin(full) + sz_a);
+  return std::vector<F>(begin(full) + sz_b - 1, begin(full) + sz_a);
+}
+
+/**
+ * @brief Circular correlation through the complex FFT, see correlate_circular.
+ * @details Like correlate_circular_exact, the linear correlation of a and b
+ * (2N - 1 terms) is folded into the N circular ones, so the transform only
+ * needs bit_ceil(2N - 1) points.
+ */
+template<typename F>
+std::vector<F> correlate_circular_fft(const F* a, const F* b, int N) {
+  int n = (int)std::bit_ceil(static_cast<unsigned>(2 * N - 1));
+  std::vector<Complex<F>> in(n);
+  for (int i = 0; i < N; ++i) in[i] = Complex<F>(a[i], b[N - 1 - i]);
+  auto linear = convolve_packed(in, 0, 2 * N - 1);
+  in = {};
+
+  // Linear term N - 1 + s plus the wrapped term s - 1
+  std::vector<F> res(N);
+  for (int s = 0; s < N; ++s) {
+    res[s] = linear[N - 1 + s] + (s > 0 ? linear[s - 1] : F(0));
+  }
+  return res;
+}
+
+/**
+ * @brief Montgomery arithmetic modulo an odd prime below 2^30, with R = 2^32.
+ * @details Values are kept in [0, mod). Every operation is branch-free so the
+ * loops using it can be auto-vectorized.
+ */
+struct Montgomery {
+  uint32_t mod, mod_neg_inv, r2;
+
+  constexpr explicit Montgomery(uint32_t mod) : mod { mod }, mod_neg_inv { 0 }, r2 { 0 } {
+    uint32_t inv = mod; // Newton iteration for mod^-1 modulo 2^32
+    for (int i = 0; i < 5; ++i) inv *= 2 - mod * inv;
+    mod_neg_inv = 0 - inv;
+    r2 = static_cast<uint32_t>((static_cast<unsigned __int128>(1) << 64) % mod);
+  }
+  constexpr uint32_t reduce(uint64_t x) const {
+    uint32_t m = static_cast<uint32_t>(x) * mod_neg_inv;
+    uint32_t t = static_cast<uint32_t>((x + static_cast<uint64_t>(m) * mod) >> 32);
+    return std::min(t, t - mod);
+  }
+  constexpr uint32_t mul(uint32_t a, uint32_t b) const { return reduce(static_cast<uint64_t>(a) * b); }
+  constexpr uint32_t add(uint32_t a, uint32_t b) const { uint32_t s = a + b; return std::min(s, s - mod); }
+  constexpr uint32_t sub(uint32_t a, uint32_t b) const { uint32_t s = a - b; return std::min(s, s + mod); }
+  constexpr uint32_t to_montgomery(uint32_t a) const { return mul(a, r2); }
+  constexpr uint32_t from_montgomery(uint32_t a) const { return reduce(a); }
+  constexpr uint32_t pow(uint32_t base, uint64_t e) const { // base and result in Montgomery form
+    uint32_t res = to_montgomery(1);
+    for (; e; e >>= 1, base = mul(base, base)) if (e & 1) res = mul(res, base);
+    return res;
+  }
+};
+
+// NTT-friendly primes with their primitive roots. All of them support transforms up to 2^24.
+inline constexpr uint32_t NTT_PRIMES[3] = {167772161, 469762049, 754974721};
+inline constexpr uint32_t NTT_ROOTS[3] = {3, 3, 11};
+inline constexpr int NTT_MAX_LOG = 24;
+
+/**
+ * @brief Twiddles of a size n transform: w[len + j] = root_{2 len}^j, in Montgomery form.
+ */
+inline std::vector<uint32_t> ntt_twiddles(const Montgomery& mt, uint32_t root, int n, bool inverse) {
+  std::vector<uint32_t> w(std::max(n, 2));
+  for (int len = 1; len < n; len *= 2) {
+    uint32_t step = mt.pow(mt.to_montgomery(root), (mt.mod - 1) / (2 * len));
+    if (inverse) step = mt.pow(step, mt.mod - 2);
+    w[len] = mt.to_montgomery(1);
+    for (int j = 1; j < len; ++j) w[len + j] = mt.mul(w[len + j - 1], step);
+  }
+  return w;
+}
+
+/**
+ * @brief Forward transform (decimation in frequency). Natural order in, bit-reversed order out.
+ */
+inline void ntt(std::vector<uint32_t>& a, const Montgomery& mt, const std::vector<uint32_t>& w) {
+  int n = (int)a.size();
+  for (int len = n / 2; len >= 1; len /= 2)
+    for (int i = 0; i < n; i += 2 * len)
+      for (int j = 0; j < len; ++j) {
+        uint32_t u = a[i + j], v = a[i + j + len];
+        a[i + j] = mt.add(u, v);
+        a[i + j + len] = mt.mul(mt.sub(u, v), w[len + j]);
+      }
+}
+
+/**
+ * @brief Inverse transform (decimation in time), without the 1/n factor. Bit-reversed order in, natural order out.
+ */
+inline void intt(std::vector<uint32_t>& a, const Montgomery& mt, const std::vector<uint32_t>& iw) {
+  int n = (int)a.size();
+  for (int len = 1; len < n; len *= 2)
+    for (int i = 0; i < n; i += 2 * len)
+      for (int j = 0; j < len; ++j) {
+        uint32_t u = a[i + j], v = mt.mul(a[i + j + len], iw[len + j]);
+        a[i + j] = mt.add(u, v);
+        a[i + j + len] = mt.sub(u, v);
+      }
+}
+
+/**
+ * @brief Twiddles and 1 / n of a size n transform, for every NTT prime.
+ */
+struct NttTables {
+  std::array<std::vector<uint32_t>, 3> forward, inverse;
+  std::array<uint32_t, 3> inverse_n; // In Montgomery form
+};
+
+/**
+ * @brief Tables of a size n transform, built on first use and then shared by
+ * every channel and frame correlated on the same thread.
+ */
+inline const NttTables& ntt_tables(int n) {
+  thread_local std::unordered_map<int, NttTables> cache;
+  auto [it, inserted] = cache.try_emplace(n);
+  if (inserted) {
+    for (int p = 0; p < 3; ++p) {
+      Montgomery mt(NTT_PRIMES[p]);
+      it->second.forward[p] = ntt_twiddles(mt, NTT_ROOTS[p], n, false);
+      it->second.inverse[p] = ntt_twiddles(mt, NTT_ROOTS[p], n, true);
+      it->second.inverse_n[p] = mt.pow(mt.to_montgomery(n), mt.mod - 2);
+    }
+  }
+  return it->second;
+}
+
+/**
+ * @brief Exact circular correlation of non-negative integer sequences below 2^30.
+ * @details The circular result is folded from a linear convolution of size
+ * n >= 2N - 1 computed modulo three NTT primes, then rebuilt with Garner's
+ * algorithm. It is exact while every term fits in 64 bits, e.g. N < 2^32 for
+ * uint16 data, and n is limited to 2^NTT_MAX_LOG.
+ */
+template<typename I>
+std::vector<int64_t> correlate_circular_exact(const I* a, const I* b, int N) {
+  int n = (int)std::bit_ceil(static_cast<unsigned>(2 * N - 1));
+
+  const auto& tables = ntt_tables(n);
+  std::array<std::vector<uint32_t>, 3> residues;
+  std::vector<uint32_t> fa(n), fb(n);
+  for (int p = 0; p < 3; ++p) {
+    Montgomery mt(NTT_PRIMES[p]);
+    std::fill(fa.begin(), fa.end(), 0);
+    std::fill(fb.begin(), fb.end(), 0);
+    for (int i = 0; i < N; ++i) {
+      fa[i] = mt.to_montgomery(static_cast<uint32_t>(a[i]));
+      fb[i] = mt.to_montgomery(static_cast<uint32_t>(b[N - 1 - i]));
+    }
+    ntt(fa, mt, tables.forward[p]);
+    ntt(fb, mt, tables.forward[p]);
+    uint32_t scale = tables.inverse_n[p];
+    for (int i = 0; i < n; ++i) fa[i] = mt.mul(mt.mul(fa[i], fb[i]), scale);
+    intt(fa, mt, tables.inverse[p]);
+    residues[p].resize(n);
+    for (int i = 0; i < n; ++i) residues[p][i] = mt.from_montgomery(fa[i]);
+  }
+
+  // Garner's algorithm, the true value fits in 64 bits so wrapping arithmetic is exact
+  const uint64_t m0 = NTT_PRIMES[0], m1 = NTT_PRIMES[1], m2 = NTT_PRIMES[2];
+  auto inverse = [](uint64_t x, uint64_t mod) {
+    uint64_t res = 1;
+    for (uint64_t e = mod - 2; e; e >>= 1, x = x * x % mod) if (e & 1) res = res * x % mod;
+    return res;
+  };
+  const uint64_t inv_m0_m1 = inverse(m0 % m1, m1), inv_m01_m2 = inverse(m0 * m1 % m2, m2);
+  auto value_at = [&](int i) -> uint64_t {
+    uint64_t r0 = residues[0][i], r1 = residues[1][i], r2 = residues[2][i];
+    uint64_t t1 = (r1 + m1 - r0 % m1) % m1 * inv_m0_m1 % m1;
+    uint64_t t2 = (r2 + m2 - (r0 + m0 * t1) % m2) % m2 * inv_m01_m2 % m2;
+    return r0 + m0 * t1 + m0 * m1 * t2;
+  };
+
+  // Linear term N - 1 + s plus the wrapped term s - 1
+  std::vector<int64_t> res(N);
+  for (int s = 0; s < N; ++s) {
+    uint64_t value = value_at(N - 1 + s);
+    if (s > 0) value += value_at(s - 1);
+    res[s] = static_cast<int64_t>(value);
+  }
+  return res;
+}
+
+/**
+ * @brief Circular correlation res[s] = sum_i a[(s + i) % N] * b[i] for s in [0, N).
+ * @details Equivalent to correlate_valid on a followed by a copy of itself, but
+ * the second copy is read through circular indexing instead of being stored.
+ * Integral inputs are correlated exactly with correlate_circular_exact; floating
+ * inputs, or transforms too large for the NTT primes, go through the complex FFT.
+ */
+template<typename F>
+std::vector<accumulator_t<F>> correlate_circular(const F* a, const F* b, int N) {
+  if (N == 0) return {};
+  if constexpr (std::is_integral_v<F>) {
+    if (2 * N - 1 <= (1 << NTT_MAX_LOG)) {
+      return correlate_circular_exact(a, b, N);
+    }
+    std::vector<double> da(a, a + N), db(b, b + N);
+    auto approx = correlate_circular(da.data(), db.data(), N);
+    std::vector<int64_t> res(N);
+    for (int i = 0; i < N; ++i) res[i] = std::llround(approx[i]);
+    return res;
+  } else {
+    return correlate_circular_fft(a, b, N);
+  }
 }
 
 }
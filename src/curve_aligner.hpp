@@ -8,6 +8,7 @@
 #include <string>
 #include <format>
 #include <stdexcept>
+#include <type_traits>
 
 #include "convolutions.hpp"
 
@@ -16,11 +17,20 @@
  * @brief A namespace containing methods for reordering multiple frames of space-filling curves paths
  * 
  * Reorder consecutive frames by minimizing pixel difference
+ *
+ * Every step is templated on value_type, the arithmetic used for the linearized
+ * pixels. float and double accumulate the L1 scores and the FFT correlation in
+ * value_type; integral types (for uint8/uint16 frames) accumulate exactly in
+ * int64, with the L2 correlation computed by an NTT. Exact scores make the
+ * chosen rotation reproducible across runs and platforms.
+ * Ties are broken in favour of the smallest shift, and the reversed
+ * orientation is only kept when it is strictly better.
  */
 namespace curve_aligner {
 
+template<typename score_type>
 struct AlignmentResult {
-  double score;
+  score_type score;
   int shift;
   bool should_maximize; // true if higher is better (Correlation), false if lower is better (L1)
 
@@ -30,43 +40,73 @@ struct AlignmentResult {
   }
 };  
 
-template<typename T>
-std::vector<std::vector<double>> linearize_image(const std::vector<std::vector<std::vector<T>>>& image, const std::vector<std::pair<int, int>>& path) {
-  std::vector<std::vector<double>> linearized_image;
-  linearized_image.reserve(path.size());
-  for(auto [r, c] : path) {
-    std::vector<double> pixel_info;
-    for(T x : image[r][c]) {
-      // for all purposes, it's safer to use floating arithmetics from now on
-      pixel_info.emplace_back(static_cast<double>(x));
+/**
+ * @brief An image linearized along a path, stored channel-major (structure of arrays).
+ * @details data[c * length + i] is channel c of the i-th pixel of the path, so
+ * every channel is a contiguous array shared by the L1 and L2 strategies.
+ */
+template<typename value_type>
+struct LinearizedImage {
+  size_t length = 0, channels = 0;
+  std::vector<value_type> data;
+
+  value_type* channel(size_t c) { return data.data() + c * length; }
+  const value_type* channel(size_t c) const { return data.data() + c * length; }
+
+  /**
+   * @brief Reverses, then rotates left by shift, every channel in place.
+   */
+  void reorient(bool reversed, size_t shift) {
+    for(size_t c = 0; c < channels; ++c) {
+      auto first = channel(c), last = channel(c) + length;
+      if(reversed) {
+        std::reverse(first, last);
+      }
+      std::rotate(first, first + shift, last);
+    }
+  }
+};
+
+template<typename value_type, typename T>
+void linearize_image(const std::vector<std::vector<std::vector<T>>>& image, const std::vector<std::pair<int, int>>& path, LinearizedImage<value_type>& linearized_image) {
+  linearized_image.length = path.size();
+  linearized_image.channels = path.empty() ? 0 : image[path[0].first][path[0].second].size();
+  linearized_image.data.resize(linearized_image.length * linearized_image.channels);
+  for(size_t c = 0; c < linearized_image.channels; ++c) {
+    auto out = linearized_image.channel(c);
+    for(size_t i = 0, len = path.size(); i < len; ++i) {
+      // float/double for floating inputs, int32 for the exact integral alignment
+      out[i] = static_cast<value_type>(image[path[i].first][path[i].second][c]);
     }
-    linearized_image.emplace_back(pixel_info);
   }
-  return linearized_image;
 }
 
-double calculate_pixel_difference(const std::vector<double>& u, const std::vector<double>& v) {
-  double cost = 0;
-  for(size_t i = 0, len = u.size(); i < len; ++i) {
-    cost += std::abs(u[i] - v[i]);
+template<typename value_type>
+convolutions::accumulator_t<value_type> calculate_pixel_difference(const LinearizedImage<value_type>& current_path, size_t u, const LinearizedImage<value_type>& previous_path, size_t v) {
+  convolutions::accumulator_t<value_type> cost = 0;
+  for(size_t c = 0, channels = current_path.channels; c < channels; ++c) {
+    cost += std::abs(current_path.channel(c)[u] - previous_path.channel(c)[v]);
   }
   return cost;
 }
 
-double calculate_pixel_weight(const auto& current_path, const auto& previous_path, size_t rot) {
-  double score = 0;
-  for(size_t lst = 0, cur = rot, len = current_path.size(); lst < len; ++lst, cur = (cur + 1 < len ? cur + 1 : 0)) {
-    score += calculate_pixel_difference(current_path[cur], previous_path[lst]);
+template<typename value_type>
+convolutions::accumulator_t<value_type> calculate_pixel_weight(const LinearizedImage<value_type>& current_path, const LinearizedImage<value_type>& previous_path, size_t rot) {
+  convolutions::accumulator_t<value_type> score = 0;
+  for(size_t lst = 0, cur = rot, len = current_path.length; lst < len; ++lst, cur = (cur + 1 < len ? cur + 1 : 0)) {
+    score += calculate_pixel_difference(current_path, cur, previous_path, lst);
   }
   return score;
 }
 
-AlignmentResult run_l1_norm_strategy(const auto& current_path, const auto& previous_path) {
-  double best_rotation_score = std::numeric_limits<double>::max();
+template<typename value_type>
+AlignmentResult<convolutions::accumulator_t<value_type>> run_l1_norm_strategy(const LinearizedImage<value_type>& current_path, const LinearizedImage<value_type>& previous_path) {
+  using score_type = convolutions::accumulator_t<value_type>;
+  score_type best_rotation_score = std::numeric_limits<score_type>::max();
   int best_rotation_id = -1;
 
-  for(size_t rot = 0, sz = current_path.size(); rot < sz; ++rot) {
-    double rotation_score = calculate_pixel_weight(current_path, previous_path, rot);
+  for(size_t rot = 0, sz = current_path.length; rot < sz; ++rot) {
+    score_type rotation_score = calculate_pixel_weight(current_path, previous_path, rot);
     if(rotation_score < best_rotation_score) {
       best_rotation_score = rotation_score;
       best_rotation_id = static_cast<int>(rot);
@@ -75,27 +115,15 @@ AlignmentResult run_l1_norm_strategy(const auto& current_path, const auto& previ
   return {best_rotation_score, best_rotation_id, false};
 }
 
-AlignmentResult run_l2_norm_strategy(auto current_path, const auto& previous_path) {
-  size_t N = current_path.size();
-  for(size_t i = 0; i < N; ++i) {
-    current_path.emplace_back(current_path[i]);
-  }
+template<typename value_type>
+AlignmentResult<convolutions::accumulator_t<value_type>> run_l2_norm_strategy(const LinearizedImage<value_type>& current_path, const LinearizedImage<value_type>& previous_path) {
+  size_t N = current_path.length;
+
+  std::vector<convolutions::accumulator_t<value_type>> total_correlation(N, 0);
+  for(size_t c = 0, channels = current_path.channels; c < channels; ++c) {
+    // The path is a cycle, so rotations are read circularly instead of duplicating it
+    auto correlation = convolutions::correlate_circular(current_path.channel(c), previous_path.channel(c), static_cast<int>(N));
 
-  std::vector<double> total_correlation(N, 0.0);
-  auto copy_from_channel = [](const auto& path, size_t c) {
-    size_t sz = path.size();
-    std::vector<double> a(sz);
-    for(size_t i = 0; i < sz; ++i) {
-      a[i] = path[i][c];
-    }
-    return a;
-  };
-  for(size_t c = 0, channels = current_path[0].size(); c < channels; ++c) {
-    auto a = copy_from_channel(current_path, c);
-    auto b = copy_from_channel(previous_path, c);
-
-    auto correlation = convolutions::correlate_valid(a, b);
-    
     for(size_t i = 0; i < N; ++i) {
       total_correlation[i] += correlation[i];
     }
@@ -106,11 +134,8 @@ AlignmentResult run_l2_norm_strategy(auto current_path, const auto& previous_pat
   return {*best_rotation_score, best_rotation_id, true};
 }
 
-AlignmentResult calculate_best_rotation(auto current_path, const auto& previous_path, const std::string& align_strategy, bool try_reverse = false) {
-  if(try_reverse) {
-    reverse(begin(current_path), end(current_path));
-  }
-
+template<typename value_type>
+AlignmentResult<convolutions::accumulator_t<value_type>> calculate_best_rotation(const LinearizedImage<value_type>& current_path, const LinearizedImage<value_type>& previous_path, const std::string& align_strategy) {
   if(align_strategy == "L1-norm") {
     return run_l1_norm_strategy(current_path, previous_path);
   }
@@ -122,31 +147,32 @@ AlignmentResult calculate_best_rotation(auto current_path, const auto& previous_
   );
 }
 
-template<typename T>
+template<typename value_type = double, typename T>
 void reorder_frames(const std::vector<std::vector<std::vector<std::vector<T>>>>& all_images, std::vector<std::vector<std::pair<int, int>>>& all_paths, const std::string& align_strategy) {
   if(align_strategy == "None") {
     return;
   }
-  auto previous_path = linearize_image(all_images[0], all_paths[0]);
+  LinearizedImage<value_type> previous_path, current_path;
+  linearize_image(all_images[0], all_paths[0], previous_path);
   for(size_t i = 1, len = all_paths.size(); i < len; ++i) {
-    auto current_path = linearize_image(all_images[i], all_paths[i]);
+    linearize_image(all_images[i], all_paths[i], current_path);
 
     auto rot_result = calculate_best_rotation(current_path, previous_path, align_strategy);
-    auto rev_rot_result = calculate_best_rotation(current_path, previous_path, align_strategy, true);
+    current_path.reorient(true, 0);
+    auto rev_rot_result = calculate_best_rotation(current_path, previous_path, align_strategy);
 
     if(rev_rot_result.is_better_than(rot_result)) {
       reverse(begin(all_paths[i]), end(all_paths[i]));
       std::rotate(begin(all_paths[i]), begin(all_paths[i]) + rev_rot_result.shift, end(all_paths[i]));
 
-      reverse(begin(current_path), end(current_path));
-      std::rotate(begin(current_path), begin(current_path) + rev_rot_result.shift, end(current_path));
+      current_path.reorient(false, rev_rot_result.shift);
     } else {
       std::rotate(begin(all_paths[i]), begin(all_paths[i]) + rot_result.shift, end(all_paths[i]));
 
-      std::rotate(begin(current_path), begin(current_path) + rot_result.shift, end(current_path));
+      current_path.reorient(true, rot_result.shift); // undo the reversal
     }
 
-    previous_path.swap(current_path);
+    std::swap(previous_path, current_path);
   }
 }
 
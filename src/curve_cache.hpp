@@ -0,0 +1,343 @@
+#ifndef CURVE_CACHE_H
+#define CURVE_CACHE_H
+
+#include <vector>
+#include <list>
+#include <string>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <format>
+#include <filesystem>
+#include <mutex>
+
+// POSIX memory mapping for the on-disk tier
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * @brief 128-bit content address of a cached curve.
+ */
+struct CurveKey {
+  uint64_t lo, hi;
+
+  bool operator==(const CurveKey& other) const = default;
+
+  std::string to_hex() const {
+    return std::format("{:016x}{:016x}", hi, lo);
+  }
+};
+
+struct CurveKeyHash {
+  size_t operator()(const CurveKey& key) const {
+    return static_cast<size_t>(key.lo);
+  }
+};
+
+/**
+ * @brief Streaming 128-bit hasher used to build CurveKeys.
+ * @details Two independent 64-bit lanes are fed 8 bytes at a time with a
+ * multiply-rotate mix, and finalized with the murmur3 avalanche. It is not
+ * cryptographic, just fast and well distributed.
+ */
+class KeyHasher {
+public:
+  void update(const void* data, size_t len) {
+    auto bytes = static_cast<const unsigned char*>(data);
+    size_t i = 0;
+    for(; i + 8 <= len; i += 8) {
+      uint64_t word;
+      std::memcpy(&word, bytes + i, 8);
+      consume(word);
+    }
+    if(i < len) {
+      uint64_t word = 0;
+      std::memcpy(&word, bytes + i, len - i);
+      consume(word);
+    }
+    length += len;
+  }
+
+  template<typename V>
+  void update_value(const V& value) {
+    update(&value, sizeof(value));
+  }
+
+  void update_string(const std::string& value) {
+    update_value(value.size());
+    update(value.data(), value.size());
+  }
+
+  CurveKey digest() const {
+    uint64_t a = fmix(h1 ^ length), b = fmix(h2 ^ length);
+    return {a + b, a + 2 * b};
+  }
+
+private:
+  static constexpr uint64_t C1 = 0x87c37b91114253d5ULL;
+  static constexpr uint64_t C2 = 0x4cf5ad432745937fULL;
+  uint64_t h1 = 0x9e3779b97f4a7c15ULL, h2 = 0xc2b2ae3d27d4eb4fULL, length = 0;
+
+  static uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  static uint64_t fmix(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+  }
+
+  void consume(uint64_t word) {
+    h1 ^= rotl(word * C1, 31) * C2;
+    h1 = rotl(h1, 27) * 5 + 0x52dce729;
+    h2 ^= rotl(word * C2, 33) * C1;
+    h2 = rotl(h2, 31) * 5 + 0x38495ab5;
+  }
+};
+
+/**
+ * @brief Content-addressed cache of computed curves.
+ * @details Entries are kept in an in-memory LRU tier of at most max_entries
+ * items holding at most max_bytes of path data, whichever limit is hit first.
+ * When a directory is given, entries are also persisted there, one file per
+ * key, and read back through a memory mapping on a memory miss.
+ *
+ * An entry is a list of paths: a single image stores one path, an animation
+ * stores one path per frame.
+ *
+ * Every member is thread-safe: the in-memory tier is guarded by a mutex, and
+ * files are read and written outside of it.
+ */
+class CurveCache {
+public:
+  using Path = std::vector<std::pair<int, int>>;
+  using Paths = std::vector<Path>;
+
+  static constexpr size_t DEFAULT_MAX_BYTES = size_t(256) << 20;
+
+  /**
+   * @param max_entries Capacity of the in-memory tier in entries. 0 disables it.
+   * @param directory Directory of the on-disk tier. Empty disables it.
+   * @param max_bytes Capacity of the in-memory tier in bytes of path data.
+   * Entries larger than it are only stored on disk.
+   */
+  CurveCache(size_t max_entries, std::string directory = "", size_t max_bytes = DEFAULT_MAX_BYTES) :
+    max_entries { max_entries },
+    max_bytes { max_bytes },
+    directory { std::move(directory) }
+  {
+    if(!this->directory.empty()) {
+      std::filesystem::create_directories(this->directory);
+    }
+  }
+
+  /**
+   * @brief Looks a key up in memory, then on disk. Disk hits are promoted to memory.
+   * @details An entry read from disk must hold path_count paths, each visiting
+   * height * width pixels inside the grid; anything else (a truncated, corrupted
+   * or foreign file) is treated as a miss.
+   */
+  std::optional<Paths> find(const CurveKey& key, int height, int width, size_t path_count = 1);
+
+  /**
+   * @brief Stores an entry in every enabled tier.
+   */
+  void insert(const CurveKey& key, const Paths& paths);
+
+  /**
+   * @brief Drops the in-memory tier. Files on disk are kept.
+   */
+  void clear() {
+    std::lock_guard lock(mutex);
+    lru.clear();
+    index.clear();
+    bytes = 0;
+  }
+
+  size_t size() const { std::lock_guard lock(mutex); return lru.size(); }
+  size_t get_bytes() const { std::lock_guard lock(mutex); return bytes; }
+  size_t get_hits() const { std::lock_guard lock(mutex); return hits; }
+  size_t get_misses() const { std::lock_guard lock(mutex); return misses; }
+
+private:
+  static constexpr uint32_t FILE_MAGIC = 0x43434653; // "SFCC"
+  static constexpr uint32_t FILE_VERSION = 1;
+
+  size_t max_entries, max_bytes;
+  std::string directory;
+  mutable std::mutex mutex; // Guards everything below
+  size_t hits = 0, misses = 0;
+  size_t bytes = 0; // Path data held by the in-memory tier
+  std::list<std::pair<CurveKey, Paths>> lru; // Most recently used first
+  std::unordered_map<CurveKey, std::list<std::pair<CurveKey, Paths>>::iterator, CurveKeyHash> index;
+
+  static size_t path_bytes(const Paths& paths) {
+    size_t total = 0;
+    for(const auto& path : paths) {
+      total += path.size() * sizeof(std::pair<int, int>);
+    }
+    return total;
+  }
+
+  // Callers hold the mutex
+  void insert_memory(const CurveKey& key, const Paths& paths);
+  std::string file_for(const CurveKey& key) const;
+  bool read_disk(const CurveKey& key, int height, int width, size_t path_count, Paths& paths) const;
+  void write_disk(const CurveKey& key, const Paths& paths) const;
+};
+
+inline std::optional<CurveCache::Paths> CurveCache::find(const CurveKey& key, int height, int width, size_t path_count) {
+  {
+    std::lock_guard lock(mutex);
+    if(auto it = index.find(key); it != index.end()) {
+      lru.splice(lru.begin(), lru, it->second);
+      hits += 1;
+      return it->second->second;
+    }
+  }
+  Paths paths;
+  bool found = read_disk(key, height, width, path_count, paths);
+  std::lock_guard lock(mutex);
+  if(found) {
+    insert_memory(key, paths);
+    hits += 1;
+    return paths;
+  }
+  misses += 1;
+  return std::nullopt;
+}
+
+inline void CurveCache::insert(const CurveKey& key, const Paths& paths) {
+  {
+    std::lock_guard lock(mutex);
+    insert_memory(key, paths);
+  }
+  write_disk(key, paths);
+}
+
+inline void CurveCache::insert_memory(const CurveKey& key, const Paths& paths) {
+  size_t entry_bytes = path_bytes(paths);
+  if(max_entries == 0 || entry_bytes > max_bytes) {
+    return;
+  }
+  if(auto it = index.find(key); it != index.end()) {
+    lru.splice(lru.begin(), lru, it->second);
+    return;
+  }
+  lru.emplace_front(key, paths);
+  index[key] = lru.begin();
+  bytes += entry_bytes;
+  while(lru.size() > max_entries || bytes > max_bytes) {
+    bytes -= path_bytes(lru.back().second);
+    index.erase(lru.back().first);
+    lru.pop_back();
+  }
+}
+
+inline std::string CurveCache::file_for(const CurveKey& key) const {
+  return directory + "/" + key.to_hex() + ".sfcc";
+}
+
+/**
+ * File layout, all little-endian uint32/int32:
+ * magic, version, path count, then for each path its length followed by
+ * (row, col) pairs.
+ */
+inline bool CurveCache::read_disk(const CurveKey& key, int height, int width, size_t path_count, Paths& paths) const {
+  if(directory.empty()) {
+    return false;
+  }
+  int fd = ::open(file_for(key).c_str(), O_RDONLY);
+  if(fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if(::fstat(fd, &st) != 0 || st.st_size < 12) {
+    ::close(fd);
+    return false;
+  }
+  size_t bytes = static_cast<size_t>(st.st_size);
+  void* mapped = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if(mapped == MAP_FAILED) {
+    return false;
+  }
+
+  auto words = static_cast<const int32_t*>(mapped);
+  size_t n_words = bytes / sizeof(int32_t), pos = 3;
+  bool ok = static_cast<uint32_t>(words[0]) == FILE_MAGIC
+    && static_cast<uint32_t>(words[1]) == FILE_VERSION
+    && static_cast<uint32_t>(words[2]) == path_count;
+  size_t pixels = static_cast<size_t>(height) * width;
+  if(ok) {
+    paths.assign(static_cast<uint32_t>(words[2]), {});
+    for(auto& path : paths) {
+      if(pos >= n_words) {
+        ok = false;
+        break;
+      }
+      size_t len = static_cast<uint32_t>(words[pos++]);
+      if(len != pixels || pos + 2 * len > n_words) {
+        ok = false;
+        break;
+      }
+      path.resize(len);
+      for(size_t i = 0; i < len && ok; ++i, pos += 2) {
+        path[i] = {words[pos], words[pos + 1]};
+        ok = words[pos] >= 0 && words[pos] < height && words[pos + 1] >= 0 && words[pos + 1] < width;
+      }
+      if(!ok) {
+        break;
+      }
+    }
+  }
+  ::munmap(mapped, bytes);
+  return ok;
+}
+
+inline void CurveCache::write_disk(const CurveKey& key, const Paths& paths) const {
+  if(directory.empty()) {
+    return;
+  }
+  std::vector<int32_t> words = {static_cast<int32_t>(FILE_MAGIC), static_cast<int32_t>(FILE_VERSION), static_cast<int32_t>(paths.size())};
+  for(const auto& path : paths) {
+    words.push_back(static_cast<int32_t>(path.size()));
+    for(auto [r, c] : path) {
+      words.push_back(r);
+      words.push_back(c);
+    }
+  }
+  // Write to a uniquely named temporary file and rename it, so readers never
+  // see a partial entry and concurrent writers of the same key never share a file
+  std::string target = file_for(key), temporary = target + ".XXXXXX";
+  int fd = ::mkstemp(temporary.data());
+  if(fd < 0) {
+    return;
+  }
+  ::fchmod(fd, 0644);
+  FILE* file = ::fdopen(fd, "wb");
+  if(file == nullptr) {
+    ::close(fd);
+    std::remove(temporary.c_str());
+    return;
+  }
+  bool ok = std::fwrite(words.data(), sizeof(int32_t), words.size(), file) == words.size();
+  ok = std::fclose(file) == 0 && ok;
+  if(ok) {
+    std::rename(temporary.c_str(), target.c_str());
+  } else {
+    std::remove(temporary.c_str());
+  }
+}
+
+#endif // !CURVE_CACHE_H
@@ -0,0 +1,455 @@
+#ifndef CURVE_ENGINE_H
+#define CURVE_ENGINE_H
+
+#include <vector>
+#include <tuple>
+#include <memory>
+#include <unordered_map>
+#include <optional>
+#include <algorithm>
+#include <string>
+#include <format>
+#include <stdexcept>
+#include <cstdint>
+#include <type_traits>
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <chrono>
+#include <functional>
+
+#include "data_driven.hpp"
+#include "quantized_data_driven.hpp"
+#include "precomputed_data_driven.hpp"
+#include "prim.hpp"
+#include "curve_aligner.hpp"
+#include "curve_cache.hpp"
+#include "metrics.hpp"
+#include "chain_code.hpp"
+#include "pyramid.hpp"
+#include "baseline_curves.hpp"
+
+/**
+ * @brief A 3D grid [x][y][channel] as consumed by the Distance classes.
+ */
+template<typename T>
+using Image = std::vector<std::vector<std::vector<T>>>;
+
+/**
+ * @brief The curve built by one (ALPHA, BLOCK_SIZE) pair of a parameter sweep.
+ */
+struct SweepResult {
+  double ALPHA;
+  int BLOCK_SIZE;
+  std::vector<std::pair<int, int>> path;
+  double locality_score; // metrics::locality_score of the path, NaN if not requested
+};
+
+/**
+ * @brief One curve of CurveEngine::compare, with its build time and quality metrics.
+ */
+struct CurveComparison {
+  std::string name;
+  std::vector<std::pair<int, int>> path;
+  double build_time_ms;
+  double locality_score;   // metrics::locality_score
+  double delta_entropy;    // metrics::delta_entropy, bits per value
+  double mean_step_length; // metrics::mean_step_length
+};
+
+/**
+ * @brief Long-lived owner of every buffer needed to build curves.
+ * @details Prim's buffers and the reshaped input frames are kept between calls.
+ * Repeated calls on same-shaped inputs reuse them without reallocating, while a
+ * different shape simply grows them. Each precision's buffers are only reserved
+ * by the first call that uses that precision, so an engine that only ever runs
+ * "float" never holds the double ones.
+ *
+ * An optional CurveCache can be attached, in which case curves are looked up
+ * by content before running Prim's algorithm.
+ */
+class CurveEngine {
+public:
+  CurveEngine() = default;
+
+  /**
+   * @brief Constructs an engine with buffers sized for H x W x C inputs.
+   */
+  CurveEngine(int height, int width, int channels) {
+    reshape(height, width, channels);
+  }
+
+  /**
+   * @brief Sets the shape of the next inputs.
+   * @details Prim's buffers are reserved for it lazily, by the next call of
+   * each precision.
+   */
+  void reshape(int height, int width, int channels) {
+    this->height = height;
+    this->width = width;
+    this->channels = channels;
+  }
+
+  int get_height() const { return height; }
+  int get_width() const { return width; }
+  int get_channels() const { return channels; }
+
+  void set_cache(std::shared_ptr<CurveCache> cache) {
+    this->cache = std::move(cache);
+  }
+  std::shared_ptr<CurveCache> get_cache() const { return cache; }
+
+  /**
+   * @brief Gets count frame buffers of type T, shaped as the engine.
+   * @details The returned frames keep their contents from the previous call and
+   * are meant to be overwritten in place.
+   */
+  template<typename T>
+  std::vector<Image<T>>& frames(int count);
+
+  /**
+   * @brief Runs the core algorithm on an image with the engine's shape.
+   *
+   * @param precision selects the arithmetic used for the edge costs. "double"
+   * is the reference path; "float" halves the bandwidth of the distances and
+   * heap; "integer" evaluates the costs in fixed-point and is only available
+   * for integral (uint8/uint16) inputs, with at most
+   * QuantizedDataDrivenDistance::MAX_CHANNELS channels. Its int64 keys are as
+   * wide as the double ones. benchmarks/precision.cpp compares them.
+   */
+  template<typename T>
+  std::vector<std::pair<int, int>> build_curve(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision);
+
+  /**
+   * @brief Builds the curve coarse to fine with pyramid::PyramidPrim, in double precision.
+   * @details The global minimum spanning tree only runs on the coarsest level,
+   * levels = 0 gives the same curve as build_curve.
+   *
+   * @param levels Number of coarse levels, clamped by the image shape.
+   */
+  template<typename T>
+  std::vector<std::pair<int, int>> build_curve_pyramid(const Image<T>& img, double ALPHA, int BLOCK_SIZE, int levels);
+
+  /**
+   * @brief Same as build_curve, but returns the curve in the chain code format.
+   * @details Without a cache, Prim's path walk writes the chain code directly.
+   */
+  template<typename T>
+  std::vector<uint8_t> build_chain_code(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision, uint32_t checkpoint_interval = chain_code::DEFAULT_CHECKPOINT_INTERVAL);
+
+  /**
+   * @brief Builds and aligns the curves of an animation with the engine's shape.
+   * @details Frames that are exact duplicates of an earlier frame reuse its
+   * curve instead of running Prim's algorithm again.
+   *
+   * @param precision as in build_curve for the curves. For the alignment,
+   * integral (uint8/uint16) frames are always aligned exactly in int32 with
+   * int64 scores, so "float" only changes the alignment of float32/float64
+   * frames. Their L1 scores are then summed in float, which is no longer exact
+   * past 2^24 (e.g. integer valued frames with more than 2^24 / 255 pixel
+   * channels), and near-tied rotations may resolve differently than in "double".
+   */
+  template<typename T>
+  std::vector<std::vector<std::pair<int, int>>> build_curves(const std::vector<Image<T>>& all_images, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy, const std::string& precision);
+
+  /**
+   * @brief Builds the curves of one image for many (ALPHA, BLOCK_SIZE) pairs.
+   * @details The image-dependent adjacency costs are evaluated once and shared
+   * by every run, and the runs are spread over threads. Each path is identical
+   * to build_curve with "double" precision for the same pair.
+   *
+   * @param with_locality whether to fill SweepResult::locality_score.
+   * @param threads number of worker threads, 0 uses the hardware concurrency.
+   */
+  template<typename T>
+  std::vector<SweepResult> sweep(const Image<T>& img, const std::vector<std::pair<double, int>>& parameters, bool with_locality, int threads);
+
+  /**
+   * @brief Builds the data driven, Hilbert, Morton and snake curves of an image
+   * with the engine's shape, and measures each of them.
+   * @details Every curve is built natively and timed the same way; the data
+   * driven one always runs Prim's algorithm, without consulting the cache.
+   */
+  template<typename T>
+  std::vector<CurveComparison> compare(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision);
+
+private:
+  int height = 0, width = 0, channels = 0;
+  std::shared_ptr<CurveCache> cache;
+  PrimWorkspace<double> double_workspace;
+  PrimWorkspace<float> float_workspace;
+  PrimWorkspace<int64_t> integer_workspace;
+  pyramid::PyramidWorkspace<double> pyramid_workspace;
+  // Fixed-point block term of the "integer" precision, rebuilt when ALPHA or BLOCK_SIZE change
+  std::shared_ptr<const QuantizedDataDrivenDistance<uint8_t>::BlockTable> block_table;
+  double block_table_alpha = 0;
+  int block_table_size = 0;
+  std::vector<PrimWorkspace<double>> sweep_workspaces; // One per sweep worker
+  std::tuple<
+    std::vector<Image<uint8_t>>,
+    std::vector<Image<uint16_t>>,
+    std::vector<Image<float>>,
+    std::vector<Image<double>>
+  > frame_buffers;
+
+  /**
+   * @brief Calls run(prim, distance) with the Prim runner and distance of the
+   * requested precision, without consulting the cache.
+   */
+  template<typename T, typename Run>
+  auto dispatch_prim(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision, Run&& run);
+
+  /**
+   * @brief Runs Prim's algorithm, without consulting the cache.
+   */
+  template<typename T>
+  std::vector<std::pair<int, int>> run_prim(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
+    return dispatch_prim(img, ALPHA, BLOCK_SIZE, precision, [](auto& prim, const auto& distance) {
+      return prim.run(distance);
+    });
+  }
+
+  /**
+   * @brief Content address of a frame's curve for the given parameters.
+   */
+  template<typename T>
+  CurveKey frame_key(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision) const;
+};
+
+template<typename T>
+std::vector<Image<T>>& CurveEngine::frames(int count) {
+  auto& buffers = std::get<std::vector<Image<T>>>(frame_buffers);
+  buffers.resize(count);
+  for(auto& img : buffers) {
+    img.resize(height);
+    for(auto& row : img) {
+      row.resize(width);
+      for(auto& pixel : row) {
+        pixel.resize(channels);
+      }
+    }
+  }
+  return buffers;
+}
+
+template<typename T, typename Run>
+auto CurveEngine::dispatch_prim(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision, Run&& run) {
+  if(precision == "double") {
+    double_workspace.reserve(height, width);
+    Prim<double, T> prim(height, width, double_workspace);
+    return run(prim, DataDrivenDistance<double, T>(img, ALPHA, BLOCK_SIZE));
+  }
+  if(precision == "float") {
+    float_workspace.reserve(height, width);
+    Prim<float, T> prim(height, width, float_workspace);
+    return run(prim, DataDrivenDistance<float, T>(img, static_cast<float>(ALPHA), BLOCK_SIZE));
+  }
+  if(precision == "integer") {
+    if constexpr (std::is_integral_v<T>) {
+      integer_workspace.reserve(height, width);
+      Prim<int64_t, T> prim(height, width, integer_workspace);
+      if(!block_table || block_table_alpha != ALPHA || block_table_size != BLOCK_SIZE) {
+        block_table = QuantizedDataDrivenDistance<T>::make_block_table(ALPHA, BLOCK_SIZE);
+        block_table_alpha = ALPHA;
+        block_table_size = BLOCK_SIZE;
+      }
+      return run(prim, QuantizedDataDrivenDistance<T>(img, ALPHA, BLOCK_SIZE, block_table));
+    } else {
+      throw std::runtime_error("Integer precision requires a uint8 or uint16 input");
+    }
+  }
+  throw std::runtime_error(
+    std::format("Unsuported precision found = {}", precision)
+  );
+}
+
+template<typename T>
+CurveKey CurveEngine::frame_key(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision) const {
+  KeyHasher hasher;
+  // dtype, shape and parameters first, then the pixels row by row
+  hasher.update_value(static_cast<int>(sizeof(T)));
+  hasher.update_value(std::is_floating_point_v<T>);
+  hasher.update_value(height);
+  hasher.update_value(width);
+  hasher.update_value(channels);
+  hasher.update_value(ALPHA);
+  hasher.update_value(BLOCK_SIZE);
+  hasher.update_string(precision);
+
+  std::vector<T> row_buffer(static_cast<size_t>(width) * channels);
+  for(const auto& row : img) {
+    auto it = row_buffer.begin();
+    for(const auto& pixel : row) {
+      it = std::copy(pixel.begin(), pixel.end(), it);
+    }
+    hasher.update(row_buffer.data(), row_buffer.size() * sizeof(T));
+  }
+  return hasher.digest();
+}
+
+template<typename T>
+std::vector<std::pair<int, int>> CurveEngine::build_curve(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
+  if(!cache) {
+    return run_prim(img, ALPHA, BLOCK_SIZE, precision);
+  }
+  auto key = frame_key(img, ALPHA, BLOCK_SIZE, precision);
+  if(auto cached = cache->find(key, height, width)) {
+    return std::move(cached->front());
+  }
+  auto path = run_prim(img, ALPHA, BLOCK_SIZE, precision);
+  cache->insert(key, {path});
+  return path;
+}
+
+template<typename T>
+std::vector<std::pair<int, int>> CurveEngine::build_curve_pyramid(const Image<T>& img, double ALPHA, int BLOCK_SIZE, int levels) {
+  double_workspace.reserve(height, width);
+  pyramid::PyramidPrim<double, T> pyramid_prim(height, width, levels, double_workspace, pyramid_workspace);
+  if(!cache) {
+    return pyramid_prim.run(img, ALPHA, BLOCK_SIZE);
+  }
+  auto key = frame_key(img, ALPHA, BLOCK_SIZE, std::format("pyramid:{}", pyramid_prim.get_levels()));
+  if(auto cached = cache->find(key, height, width)) {
+    return std::move(cached->front());
+  }
+  auto path = pyramid_prim.run(img, ALPHA, BLOCK_SIZE);
+  cache->insert(key, {path});
+  return path;
+}
+
+template<typename T>
+std::vector<uint8_t> CurveEngine::build_chain_code(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision, uint32_t checkpoint_interval) {
+  if(cache) {
+    return chain_code::encode(build_curve(img, ALPHA, BLOCK_SIZE, precision), height, width, checkpoint_interval);
+  }
+  return dispatch_prim(img, ALPHA, BLOCK_SIZE, precision, [&](auto& prim, const auto& distance) {
+    return prim.run_chain_code(distance, checkpoint_interval);
+  });
+}
+
+template<typename T>
+std::vector<std::vector<std::pair<int, int>>> CurveEngine::build_curves(const std::vector<Image<T>>& all_images, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy, const std::string& precision) {
+  int frame_count = static_cast<int>(all_images.size());
+  std::vector<CurveKey> keys(frame_count);
+  KeyHasher animation_hasher;
+  for(int f = 0; f < frame_count; ++f) {
+    keys[f] = frame_key(all_images[f], ALPHA, BLOCK_SIZE, precision);
+    animation_hasher.update_value(keys[f]);
+  }
+  animation_hasher.update_string(align_strategy);
+  auto animation_key = animation_hasher.digest();
+
+  if(cache) {
+    if(auto cached = cache->find(animation_key, height, width, frame_count)) {
+      return std::move(*cached);
+    }
+  }
+
+  std::vector<std::vector<std::pair<int, int>>> all_paths(frame_count);
+  std::unordered_map<CurveKey, int, CurveKeyHash> first_frame;
+  for(int f = 0; f < frame_count; ++f) {
+    auto [it, inserted] = first_frame.emplace(keys[f], f);
+    if(!inserted && all_images[it->second] == all_images[f]) {
+      all_paths[f] = all_paths[it->second]; // exact duplicate frame
+      continue;
+    }
+    std::optional<CurveCache::Paths> cached;
+    if(cache) {
+      cached = cache->find(keys[f], height, width);
+    }
+    if(cached) {
+      all_paths[f] = std::move(cached->front());
+    } else {
+      all_paths[f] = run_prim(all_images[f], ALPHA, BLOCK_SIZE, precision);
+      if(cache) {
+        cache->insert(keys[f], {all_paths[f]});
+      }
+    }
+  }
+
+  if constexpr (std::is_integral_v<T>) {
+    // Quantized frames are aligned with exact integer scores
+    curve_aligner::reorder_frames<int32_t>(all_images, all_paths, align_strategy);
+  } else if(precision == "float") {
+    curve_aligner::reorder_frames<float>(all_images, all_paths, align_strategy);
+  } else {
+    curve_aligner::reorder_frames<double>(all_images, all_paths, align_strategy);
+  }
+  if(cache) {
+    cache->insert(animation_key, all_paths);
+  }
+  return all_paths;
+}
+
+template<typename T>
+std::vector<CurveComparison> CurveEngine::compare(const Image<T>& img, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
+  std::vector<std::pair<std::string, std::function<std::vector<std::pair<int, int>>()>>> builders = {
+    {"data-driven", [&] { return run_prim(img, ALPHA, BLOCK_SIZE, precision); }},
+    {"hilbert", [&] { return baseline_curves::hilbert(height, width); }},
+    {"morton", [&] { return baseline_curves::morton(height, width); }},
+    {"snake", [&] { return baseline_curves::snake(height, width); }}
+  };
+  std::vector<CurveComparison> results;
+  for(auto& [name, build] : builders) {
+    auto start = std::chrono::steady_clock::now();
+    auto path = build();
+    auto end = std::chrono::steady_clock::now();
+    CurveComparison result{name, {}, std::chrono::duration<double, std::milli>(end - start).count(), 0, 0, 0};
+    result.locality_score = metrics::locality_score(img, path);
+    result.delta_entropy = metrics::delta_entropy(img, path);
+    result.mean_step_length = metrics::mean_step_length(path);
+    result.path = std::move(path);
+    results.push_back(std::move(result));
+  }
+  return results;
+}
+
+template<typename T>
+std::vector<SweepResult> CurveEngine::sweep(const Image<T>& img, const std::vector<std::pair<double, int>>& parameters, bool with_locality, int threads) {
+  auto adj_costs = DataDrivenDistance<double, T>(img, 0, 1).adj_edge_costs();
+  std::vector<SweepResult> results(parameters.size());
+  if(parameters.empty()) {
+    return results;
+  }
+
+  int workers = threads > 0 ? threads : static_cast<int>(std::thread::hardware_concurrency());
+  workers = std::clamp(workers, 1, static_cast<int>(parameters.size()));
+  if(static_cast<int>(sweep_workspaces.size()) < workers) {
+    sweep_workspaces.resize(workers);
+  }
+
+  std::atomic<size_t> next = 0;
+  std::vector<std::exception_ptr> errors(workers);
+  auto work = [&](int worker) {
+    try {
+      for(size_t i; (i = next++) < parameters.size(); ) {
+        auto [ALPHA, BLOCK_SIZE] = parameters[i];
+        auto path = Prim<double, T>(height, width, sweep_workspaces[worker]).run(
+          PrecomputedDataDrivenDistance<double, T>(img, adj_costs, ALPHA, BLOCK_SIZE)
+        );
+        double locality = with_locality ? metrics::locality_score(img, path) : std::numeric_limits<double>::quiet_NaN();
+        results[i] = {ALPHA, BLOCK_SIZE, std::move(path), locality};
+      }
+    } catch(...) {
+      errors[worker] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for(int worker = 1; worker < workers; ++worker) {
+    pool.emplace_back(work, worker);
+  }
+  work(0);
+  for(auto& thread : pool) {
+    thread.join();
+  }
+  for(auto& error : errors) {
+    if(error) {
+      std::rethrow_exception(error);
+    }
+  }
+  return results;
+}
+
+#endif // !CURVE_ENGINE_H
@@ -0,0 +1,305 @@
+#ifndef CURVE_INDEX_H
+#define CURVE_INDEX_H
+
+#include <vector>
+#include <utility>
+#include <tuple>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+
+/**
+ * @brief A half-open range [first, second) of positions along a curve.
+ */
+using CurveInterval = std::pair<int64_t, int64_t>;
+
+/**
+ * @brief Range-query index over a curve used as a storage order.
+ * @details It keeps the rank grid, the position of every pixel along the curve,
+ * and a hierarchy of square tiles of side 2^k with the min and max rank of
+ * each tile.
+ *
+ * When every step of the curve moves to a 4-neighbour, as for the data driven
+ * curves, an interval can only start or end on the border of the rectangle, so
+ * a query only reads the border pixels. Other curves (e.g. Z-order) walk the
+ * tiles top-down instead: tiles outside the rectangle are skipped, and a tile
+ * inside it whose ranks are contiguous (max - min + 1 equals its pixel count)
+ * is emitted as one interval without visiting its pixels.
+ */
+class CurveIndex {
+public:
+  CurveIndex(const std::vector<std::pair<int, int>>& path, int height, int width);
+
+  int get_height() const { return height; }
+  int get_width() const { return width; }
+
+  /**
+   * @brief Position of pixel (x, y) along the curve.
+   * @throws std::out_of_range if (x, y) is outside the image.
+   */
+  int32_t rank(int x, int y) const {
+    if(x < 0 || y < 0 || x >= height || y >= width) {
+      throw std::out_of_range(std::format("Pixel ({}, {}) is out of a {}x{} image", x, y, height, width));
+    }
+    return ranks[0][static_cast<size_t>(x) * width + y];
+  }
+
+  /**
+   * @brief Minimal list of curve intervals covering the pixels of rows
+   * [row_begin, row_end) and cols [col_begin, col_end), sorted by position.
+   * @details The bounds are clamped to the image, and every returned interval
+   * is shifted by offset.
+   */
+  std::vector<CurveInterval> query(int row_begin, int row_end, int col_begin, int col_end, int64_t offset = 0) const;
+
+  /**
+   * @brief Same as query, but appends the intervals to out without sorting or merging them.
+   */
+  void collect(int row_begin, int row_end, int col_begin, int col_end, int64_t offset, std::vector<CurveInterval>& out) const;
+
+  /**
+   * @brief Smallest single interval [min rank, max rank + 1) covering the rectangle,
+   * read from the tile hierarchy. It is empty for an empty rectangle.
+   */
+  CurveInterval bounds(int row_begin, int row_end, int col_begin, int col_end) const;
+
+  /**
+   * @brief Sorts intervals and merges the ones that touch, in place.
+   */
+  static void normalize(std::vector<CurveInterval>& intervals);
+
+private:
+  int height, width;
+  std::vector<std::pair<int, int>> path;
+  bool is_connected = true; // Whether every step moves to a 4-neighbour
+  // Level k has tiles of side 2^k, level 0 holds the rank grid itself
+  std::vector<std::pair<int, int>> shapes;
+  std::vector<std::vector<int32_t>> ranks; // Min rank of each tile
+  std::vector<std::vector<int32_t>> max_ranks; // Max rank of each tile, empty for level 0
+
+  void collect_border(int row_begin, int row_end, int col_begin, int col_end, int64_t offset, std::vector<CurveInterval>& out) const;
+  void collect_tiles(int row_begin, int row_end, int col_begin, int col_end, int64_t offset, std::vector<CurveInterval>& out) const;
+};
+
+inline CurveIndex::CurveIndex(const std::vector<std::pair<int, int>>& path, int height, int width) :
+  height { height },
+  width { width },
+  path { path }
+{
+  if(path.size() != static_cast<size_t>(height) * width) {
+    throw std::runtime_error(std::format("Path has {} pixels, expected {}", path.size(), static_cast<size_t>(height) * width));
+  }
+  shapes.emplace_back(height, width);
+  ranks.emplace_back(path.size(), -1);
+  max_ranks.emplace_back();
+  for(size_t i = 0, len = path.size(); i < len; ++i) {
+    auto [x, y] = path[i];
+    if(x < 0 || y < 0 || x >= height || y >= width || ranks[0][static_cast<size_t>(x) * width + y] != -1) {
+      throw std::runtime_error(std::format("Path is not a permutation of the pixels, found ({}, {}) at position {}", x, y, i));
+    }
+    ranks[0][static_cast<size_t>(x) * width + y] = static_cast<int32_t>(i);
+    if(i > 0 && std::abs(x - path[i - 1].first) + std::abs(y - path[i - 1].second) != 1) {
+      is_connected = false;
+    }
+  }
+
+  while(shapes.back().first > 1 || shapes.back().second > 1) {
+    auto [fine_r, fine_c] = shapes.back();
+    int coarse_r = (fine_r + 1) / 2, coarse_c = (fine_c + 1) / 2;
+    const auto& fine_min = ranks.back();
+    const auto& fine_max = max_ranks.back().empty() ? ranks.back() : max_ranks.back();
+    std::vector<int32_t> coarse_min(static_cast<size_t>(coarse_r) * coarse_c), coarse_max(coarse_min.size());
+    for(int x = 0; x < coarse_r; ++x) {
+      for(int y = 0; y < coarse_c; ++y) {
+        int32_t lo = INT32_MAX, hi = INT32_MIN;
+        for(int fx = 2 * x; fx < std::min(2 * x + 2, fine_r); ++fx) {
+          for(int fy = 2 * y; fy < std::min(2 * y + 2, fine_c); ++fy) {
+            lo = std::min(lo, fine_min[static_cast<size_t>(fx) * fine_c + fy]);
+            hi = std::max(hi, fine_max[static_cast<size_t>(fx) * fine_c + fy]);
+          }
+        }
+        coarse_min[static_cast<size_t>(x) * coarse_c + y] = lo;
+        coarse_max[static_cast<size_t>(x) * coarse_c + y] = hi;
+      }
+    }
+    shapes.emplace_back(coarse_r, coarse_c);
+    ranks.emplace_back(std::move(coarse_min));
+    max_ranks.emplace_back(std::move(coarse_max));
+  }
+}
+
+inline void CurveIndex::collect(int row_begin, int row_end, int col_begin, int col_end, int64_t offset, std::vector<CurveInterval>& out) const {
+  row_begin = std::max(row_begin, 0);
+  col_begin = std::max(col_begin, 0);
+  row_end = std::min(row_end, height);
+  col_end = std::min(col_end, width);
+  if(row_begin >= row_end || col_begin >= col_end) {
+    return;
+  }
+  if(is_connected) {
+    collect_border(row_begin, row_end, col_begin, col_end, offset, out);
+  } else {
+    collect_tiles(row_begin, row_end, col_begin, col_end, offset, out);
+  }
+}
+
+inline void CurveIndex::collect_border(int row_begin, int row_end, int col_begin, int col_end, int64_t offset, std::vector<CurveInterval>& out) const {
+  auto inside = [&](std::pair<int, int> pixel) {
+    return pixel.first >= row_begin && pixel.first < row_end && pixel.second >= col_begin && pixel.second < col_end;
+  };
+  int64_t last = static_cast<int64_t>(path.size()) - 1;
+  std::vector<int64_t> starts, ends;
+  if(inside(path.front())) starts.push_back(0);
+  if(inside(path.back())) ends.push_back(last + 1);
+  auto visit = [&](int x, int y) {
+    int64_t k = ranks[0][static_cast<size_t>(x) * width + y];
+    if(k > 0 && !inside(path[k - 1])) starts.push_back(k);
+    if(k < last && !inside(path[k + 1])) ends.push_back(k + 1);
+  };
+  // Every border pixel once, including 1-wide rectangles
+  for(int x = row_begin; x < row_end; ++x) {
+    if(x == row_begin || x == row_end - 1) {
+      for(int y = col_begin; y < col_end; ++y) visit(x, y);
+    } else {
+      visit(x, col_begin);
+      if(col_end - 1 != col_begin) visit(x, col_end - 1);
+    }
+  }
+  // Runs are disjoint, so the i-th start pairs with the i-th end
+  std::sort(starts.begin(), starts.end());
+  std::sort(ends.begin(), ends.end());
+  for(size_t i = 0, len = starts.size(); i < len; ++i) {
+    out.emplace_back(offset + starts[i], offset + ends[i]);
+  }
+}
+
+inline void CurveIndex::collect_tiles(int row_begin, int row_end, int col_begin, int col_end, int64_t offset, std::vector<CurveInterval>& out) const {
+  // Tiles left to visit as (level, x, y), starting from the single top tile
+  std::vector<std::tuple<int, int, int>> stack = {{static_cast<int>(shapes.size()) - 1, 0, 0}};
+  while(!stack.empty()) {
+    auto [level, x, y] = stack.back();
+    stack.pop_back();
+    int r0 = x << level, c0 = y << level;
+    int r1 = std::min((x + 1) << level, height), c1 = std::min((y + 1) << level, width);
+    if(r1 <= row_begin || r0 >= row_end || c1 <= col_begin || c0 >= col_end) {
+      continue;
+    }
+    size_t tile = static_cast<size_t>(x) * shapes[level].second + y;
+    int64_t lo = ranks[level][tile];
+    if(level == 0) {
+      out.emplace_back(offset + lo, offset + lo + 1);
+      continue;
+    }
+    int64_t hi = max_ranks[level][tile];
+    bool inside = r0 >= row_begin && r1 <= row_end && c0 >= col_begin && c1 <= col_end;
+    if(inside && hi - lo + 1 == static_cast<int64_t>(r1 - r0) * (c1 - c0)) {
+      out.emplace_back(offset + lo, offset + hi + 1);
+      continue;
+    }
+    auto [fine_r, fine_c] = shapes[level - 1];
+    for(int fx = 2 * x; fx < std::min(2 * x + 2, fine_r); ++fx) {
+      for(int fy = 2 * y; fy < std::min(2 * y + 2, fine_c); ++fy) {
+        stack.emplace_back(level - 1, fx, fy);
+      }
+    }
+  }
+}
+
+inline CurveInterval CurveIndex::bounds(int row_begin, int row_end, int col_begin, int col_end) const {
+  row_begin = std::max(row_begin, 0);
+  col_begin = std::max(col_begin, 0);
+  row_end = std::min(row_end, height);
+  col_end = std::min(col_end, width);
+  if(row_begin >= row_end || col_begin >= col_end) {
+    return {0, 0};
+  }
+  int64_t lo = INT64_MAX, hi = INT64_MIN;
+  std::vector<std::tuple<int, int, int>> stack = {{static_cast<int>(shapes.size()) - 1, 0, 0}};
+  while(!stack.empty()) {
+    auto [level, x, y] = stack.back();
+    stack.pop_back();
+    int r0 = x << level, c0 = y << level;
+    int r1 = std::min((x + 1) << level, height), c1 = std::min((y + 1) << level, width);
+    if(r1 <= row_begin || r0 >= row_end || c1 <= col_begin || c0 >= col_end) {
+      continue;
+    }
+    size_t tile = static_cast<size_t>(x) * shapes[level].second + y;
+    int64_t tile_lo = ranks[level][tile], tile_hi = level == 0 ? tile_lo : max_ranks[level][tile];
+    if(tile_lo >= lo && tile_hi <= hi) {
+      continue; // Cannot widen the bounds
+    }
+    if(level == 0 || (r0 >= row_begin && r1 <= row_end && c0 >= col_begin && c1 <= col_end)) {
+      lo = std::min(lo, tile_lo);
+      hi = std::max(hi, tile_hi);
+      continue;
+    }
+    auto [fine_r, fine_c] = shapes[level - 1];
+    for(int fx = 2 * x; fx < std::min(2 * x + 2, fine_r); ++fx) {
+      for(int fy = 2 * y; fy < std::min(2 * y + 2, fine_c); ++fy) {
+        stack.emplace_back(level - 1, fx, fy);
+      }
+    }
+  }
+  return {lo, hi + 1};
+}
+
+inline void CurveIndex::normalize(std::vector<CurveInterval>& intervals) {
+  std::sort(intervals.begin(), intervals.end());
+  size_t merged = 0;
+  for(size_t i = 0, len = intervals.size(); i < len; ++i) {
+    if(merged > 0 && intervals[merged - 1].second >= intervals[i].first) {
+      intervals[merged - 1].second = std::max(intervals[merged - 1].second, intervals[i].second);
+    } else {
+      intervals[merged++] = intervals[i];
+    }
+  }
+  intervals.resize(merged);
+}
+
+inline std::vector<CurveInterval> CurveIndex::query(int row_begin, int row_end, int col_begin, int col_end, int64_t offset) const {
+  std::vector<CurveInterval> intervals;
+  collect(row_begin, row_end, col_begin, col_end, offset, intervals);
+  normalize(intervals);
+  return intervals;
+}
+
+/**
+ * @brief Range-query index over the curves of an animation stored frame after frame.
+ * @details Frame f occupies positions [f * H * W, (f + 1) * H * W), so intervals
+ * of consecutive frames are merged when a frame's curve ends inside the
+ * rectangle and the next one starts there.
+ */
+class AnimationIndex {
+public:
+  AnimationIndex(const std::vector<std::vector<std::pair<int, int>>>& paths, int height, int width) {
+    frames.reserve(paths.size());
+    for(const auto& path : paths) {
+      frames.emplace_back(path, height, width);
+    }
+  }
+
+  size_t size() const { return frames.size(); }
+  const CurveIndex& frame(size_t f) const { return frames[f]; }
+
+  /**
+   * @brief Minimal list of intervals covering the rectangle in frames [frame_begin, frame_end).
+   */
+  std::vector<CurveInterval> query(int row_begin, int row_end, int col_begin, int col_end, int frame_begin, int frame_end) const {
+    std::vector<CurveInterval> intervals;
+    frame_begin = std::max(frame_begin, 0);
+    frame_end = std::min(frame_end, static_cast<int>(frames.size()));
+    for(int f = frame_begin; f < frame_end; ++f) {
+      const auto& index = frames[f];
+      index.collect(row_begin, row_end, col_begin, col_end, static_cast<int64_t>(f) * index.get_height() * index.get_width(), intervals);
+    }
+    CurveIndex::normalize(intervals);
+    return intervals;
+  }
+
+private:
+  std::vector<CurveIndex> frames;
+};
+
+#endif // !CURVE_INDEX_H
@@ -38,13 +38,21 @@ public:
    * @return The calculated cost or distance.
    */
   distance_type get_distance(std::pair<int, int> id_a, std::pair<int, int> id_b) const override;
-private:
+  /**
+   * @brief Evaluates the image-dependent adjacency cost of every node edge.
+   * @details Entry (x * node_c + y) * 4 + d holds the cost of merging the node
+   * (x + DIR_X[d], y + DIR_Y[d]) into (x, y), or 0 if it is outside the grid.
+   * It does not depend on ALPHA or BLOCK.
+   */
+  std::vector<distance_type> adj_edge_costs() const;
+protected:
   distance_type ALPHA;
+  distance_type block_edge_cost(std::pair<int, int> id_b) const;
+private:
   int BLOCK;
   std::pair<distance_type, distance_type> BLOCK_CENTER;
   distance_type adj_edge_cost(std::pair<int, int> id_a, std::pair<int, int> id_b) const;
   distance_type pixel_edge_cost(std::pair<int, int> a, std::pair<int, int> b) const;
-  distance_type block_edge_cost(std::pair<int, int> id_b) const;
 };
 
 
@@ -71,20 +79,17 @@ distance_type DataDrivenDistance<distance_type, grid_type>::pixel_edge_cost(std:
 template<typename distance_type, typename grid_type>
 distance_type DataDrivenDistance<distance_type, grid_type>::adj_edge_cost(std::pair<int, int> id_a, std::pair<int, int> id_b) const {
   distance_type cost = 0;
-  auto cycle_b = util::get_node_cycle(id_b);
-  std::pair<int, int> dir_ab = {id_b.first - id_a.first, id_b.second - id_a.second};
-  for(int e = 0; e < 4; ++e) {
-    int ne = e + 1 == 4 ? 0 : e + 1;
-    std::pair<int, int> dir(cycle_b[ne].first - cycle_b[e].first, cycle_b[ne].second - cycle_b[e].second);
-    auto u = util::cross(dir_ab, dir);
-    if(u <= 0) { // parallel or clockwise 
-      cost += pixel_edge_cost(cycle_b[e], cycle_b[ne]);
-    }
+  const auto& topology = util::get_merge_topology(id_a, id_b);
+  for(const auto& edge : topology.kept) {
+    auto [u, v] = edge.at(id_a);
+    cost += pixel_edge_cost(u, v);
   }
-  for(auto [u, v] : util::get_removed_edges(id_a, id_b)) {
+  for(const auto& edge : topology.removed) {
+    auto [u, v] = edge.at(id_a);
     cost -= pixel_edge_cost(u, v);
   }
-  for(auto [u, v] : util::get_added_edges(id_a, id_b)) {
+  for(const auto& edge : topology.added) {
+    auto [u, v] = edge.at(id_a);
     cost += pixel_edge_cost(u, v);
   }
   return cost;
@@ -95,4 +100,21 @@ distance_type DataDrivenDistance<distance_type, grid_type>::get_distance(std::pa
   return (1 - ALPHA) * adj_edge_cost(id_a, id_b) + ALPHA * block_edge_cost(id_b);
 }
 
+template<typename distance_type, typename grid_type>
+std::vector<distance_type> DataDrivenDistance<distance_type, grid_type>::adj_edge_costs() const {
+  int node_r = static_cast<int>(this->grid.size()) / 2;
+  int node_c = node_r == 0 ? 0 : static_cast<int>(this->grid[0].size()) / 2;
+  std::vector<distance_type> costs(static_cast<size_t>(node_r) * node_c * 4, 0);
+  for(int x = 0; x < node_r; ++x) {
+    for(int y = 0; y < node_c; ++y) {
+      for(int d = 0; d < 4; ++d) {
+        int nx = x + util::DIR_X[d], ny = y + util::DIR_Y[d];
+        if(nx < 0 || ny < 0 || nx >= node_r || ny >= node_c) continue;
+        costs[(static_cast<size_t>(x) * node_c + y) * 4 + d] = adj_edge_cost({x, y}, {nx, ny});
+      }
+    }
+  }
+  return costs;
+}
+
 #endif // !DATA_DRIVEN_H
\ No newline at end of file
@@ -5,10 +5,14 @@
 #include <iostream>
 #include <string>
 #include <chrono>
+#include <memory>
+#include <limits>
+#include <cstring>
+#include <format>
 
-#include "data_driven.hpp"
-#include "prim.hpp"
+#include "curve_engine.hpp"
 #include "curve_aligner.hpp"
+#include "curve_index.hpp"
 
 namespace py = pybind11;
 
@@ -18,7 +22,7 @@ struct PerformanceMetrics {
 };
 
 template<typename T>
-std::vector<std::vector<std::vector<T>>> reshape_image(const py::array_t<T>& input_array) {
+void reshape_image(const py::array_t<T>& input_array, Image<T>& img) {
   auto buf = input_array.request();
   int height = buf.shape[0];
   int width = buf.shape[1];
@@ -26,7 +30,7 @@ std::vector<std::vector<std::vector<T>>> reshape_image(const py::array_t<T>& inp
   // Check if we have a 3rd dimension (channels). If not, assume 1 channel.
   int channels = (buf.ndim == 3) ? buf.shape[2] : 1;
 
-  std::vector<std::vector<std::vector<T>>> img(height);
+  img.resize(height);
 
   for(int r = 0; r < height; ++r) {
     img[r].resize(width);
@@ -41,11 +45,10 @@ std::vector<std::vector<std::vector<T>>> reshape_image(const py::array_t<T>& inp
       }
     }
   }
-  return img;
 }
 
 template<typename T>
-std::vector<std::vector<std::vector<T>>> reshape_image_frame(const py::array_t<T>& input_array, int frame_idx) {
+void reshape_image_frame(const py::array_t<T>& input_array, int frame_idx, Image<T>& img) {
   auto buf = input_array.request();
   int height = buf.shape[1];
   int width = buf.shape[2];
@@ -53,7 +56,7 @@ std::vector<std::vector<std::vector<T>>> reshape_image_frame(const py::array_t<T
   // Check if we have a 4rd dimension (channels). If not, assume 1 channel.
   int channels = (buf.ndim == 4) ? buf.shape[3] : 1;
 
-  std::vector<std::vector<std::vector<T>>> img(height);
+  img.resize(height);
 
   for(int r = 0; r < height; ++r) {
     img[r].resize(width);
@@ -68,7 +71,6 @@ std::vector<std::vector<std::vector<T>>> reshape_image_frame(const py::array_t<T
       }
     }
   }
-  return img;
 }
 
 /**
@@ -79,7 +81,7 @@ std::vector<std::vector<std::vector<T>>> reshape_image_frame(const py::array_t<T
  * pixel adjacency is considered.
  */
 template<typename T>
-std::pair<std::vector<std::pair<int, int>>, PerformanceMetrics> data_driven_process_image(py::array_t<T> input_array, double ALPHA, int BLOCK_SIZE) {
+std::pair<std::vector<std::pair<int, int>>, PerformanceMetrics> data_driven_process_image(CurveEngine& engine, py::array_t<T> input_array, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
   auto start_total = std::chrono::steady_clock::now();
   if(input_array.ndim() != 2 && input_array.ndim() != 3) {
     throw std::runtime_error("Input image must be 2D [H,W] or 3D [H,W,C]");
@@ -87,12 +89,15 @@ std::pair<std::vector<std::pair<int, int>>, PerformanceMetrics> data_driven_proc
   // Part of pybind ovearhead
   int height = input_array.shape(0);
   int width = input_array.shape(1);
-  auto img = reshape_image(input_array);
+  int channels = input_array.ndim() == 3 ? input_array.shape(2) : 1;
+  engine.reshape(height, width, channels);
+  auto& img = engine.frames<T>(1)[0];
+  reshape_image(input_array, img);
 
   auto start_core = std::chrono::steady_clock::now();
 
   // Core algorithm logic
-  auto result_path = Prim<double, T>(height, width).run(DataDrivenDistance<double, T>(img, ALPHA, BLOCK_SIZE));
+  auto result_path = engine.build_curve(img, ALPHA, BLOCK_SIZE, precision);
 
   auto end_time = std::chrono::steady_clock::now();  
 
@@ -103,15 +108,96 @@ std::pair<std::vector<std::pair<int, int>>, PerformanceMetrics> data_driven_proc
   return {result_path, stats};
 }
 
+/**
+ * Process a single image coarse to fine.
+ *
+ * The global ordering is decided on a downsampled pyramid level and refined
+ * level by level, see pyramid::PyramidPrim.
+ */
+template<typename T>
+std::vector<std::pair<int, int>> data_driven_process_pyramid(CurveEngine& engine, py::array_t<T> input_array, double ALPHA, int BLOCK_SIZE, int levels) {
+  if(input_array.ndim() != 2 && input_array.ndim() != 3) {
+    throw std::runtime_error("Input image must be 2D [H,W] or 3D [H,W,C]");
+  }
+  int height = input_array.shape(0);
+  int width = input_array.shape(1);
+  int channels = input_array.ndim() == 3 ? input_array.shape(2) : 1;
+  engine.reshape(height, width, channels);
+  auto& img = engine.frames<T>(1)[0];
+  reshape_image(input_array, img);
+
+  return engine.build_curve_pyramid(img, ALPHA, BLOCK_SIZE, levels);
+}
+
+/**
+ * Process a single image with every curve, see CurveEngine::compare.
+ */
+template<typename T>
+std::vector<CurveComparison> data_driven_process_comparison(CurveEngine& engine, py::array_t<T> input_array, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
+  if(input_array.ndim() != 2 && input_array.ndim() != 3) {
+    throw std::runtime_error("Input image must be 2D [H,W] or 3D [H,W,C]");
+  }
+  int height = input_array.shape(0);
+  int width = input_array.shape(1);
+  int channels = input_array.ndim() == 3 ? input_array.shape(2) : 1;
+  engine.reshape(height, width, channels);
+  auto& img = engine.frames<T>(1)[0];
+  reshape_image(input_array, img);
+
+  return engine.compare(img, ALPHA, BLOCK_SIZE, precision);
+}
+
+/**
+ * Process a single image into the chain code format.
+ *
+ * Prim's path walk writes the packed bytes directly.
+ */
+template<typename T>
+std::vector<uint8_t> data_driven_process_chain_code(CurveEngine& engine, py::array_t<T> input_array, double ALPHA, int BLOCK_SIZE, const std::string& precision, uint32_t checkpoint_interval) {
+  if(input_array.ndim() != 2 && input_array.ndim() != 3) {
+    throw std::runtime_error("Input image must be 2D [H,W] or 3D [H,W,C]");
+  }
+  int height = input_array.shape(0);
+  int width = input_array.shape(1);
+  int channels = input_array.ndim() == 3 ? input_array.shape(2) : 1;
+  engine.reshape(height, width, channels);
+  auto& img = engine.frames<T>(1)[0];
+  reshape_image(input_array, img);
+
+  return engine.build_chain_code(img, ALPHA, BLOCK_SIZE, precision, checkpoint_interval);
+}
+
+/**
+ * Process a single image for many (ALPHA, BLOCK_SIZE) pairs.
+ *
+ * The image-dependent costs are computed once and shared by every pair.
+ */
+template<typename T>
+std::vector<SweepResult> data_driven_process_sweep(CurveEngine& engine, py::array_t<T> input_array, const std::vector<std::pair<double, int>>& parameters, bool with_locality, int threads) {
+  if(input_array.ndim() != 2 && input_array.ndim() != 3) {
+    throw std::runtime_error("Input image must be 2D [H,W] or 3D [H,W,C]");
+  }
+  int height = input_array.shape(0);
+  int width = input_array.shape(1);
+  int channels = input_array.ndim() == 3 ? input_array.shape(2) : 1;
+  engine.reshape(height, width, channels);
+  auto& img = engine.frames<T>(1)[0];
+  reshape_image(input_array, img);
+
+  return engine.sweep(img, parameters, with_locality, threads);
+}
+
 /**
  * Process a list of images.
  * 
  * If the align_strategy is set, it will try each cyclic shift
  * in a way that best match previous path data. Cyclic shifts
  * are considered in both directions.
+ *
+ * Frames identical to an earlier frame reuse its curve.
  */
 template<typename T>
-std::pair<std::vector<std::vector<std::pair<int, int>>>, PerformanceMetrics> data_driven_process_multiple_images(py::array_t<T> input_array, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy) {
+std::pair<std::vector<std::vector<std::pair<int, int>>>, PerformanceMetrics> data_driven_process_multiple_images(CurveEngine& engine, py::array_t<T> input_array, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy, const std::string& precision) {
   auto start_total = std::chrono::steady_clock::now();
   if(input_array.ndim() != 3 && input_array.ndim() != 4) {
     throw std::runtime_error("Input animation must be 3D [F,H,W] or 4D [F,H,W,C]");
@@ -120,21 +206,18 @@ std::pair<std::vector<std::vector<std::pair<int, int>>>, PerformanceMetrics> dat
   int frames = input_array.shape(0);
   int height = input_array.shape(1);
   int width = input_array.shape(2);
+  int channels = input_array.ndim() == 4 ? input_array.shape(3) : 1;
+  engine.reshape(height, width, channels);
 
-  std::vector<std::vector<std::vector<std::vector<T>>>> all_images(frames);
-  std::vector<std::vector<std::pair<int, int>>> all_paths(frames);
+  auto& all_images = engine.frames<T>(frames);
 
   for(int f = 0; f < frames; ++f) {
-    all_images[f] = reshape_image_frame(input_array, f);
+    reshape_image_frame(input_array, f, all_images[f]);
   }
 
   auto start_core = std::chrono::steady_clock::now();
 
-  for(int f = 0; f < frames; ++f) {
-    all_paths[f] = Prim<double, T>(height, width).run(DataDrivenDistance<double, T>(all_images[f], ALPHA, BLOCK_SIZE));
-  }
-  
-  curve_aligner::reorder_frames(all_images, all_paths, align_strategy);
+  auto all_paths = engine.build_curves(all_images, ALPHA, BLOCK_SIZE, align_strategy, precision);
   auto end_time = std::chrono::steady_clock::now();
 
   PerformanceMetrics stats{
@@ -145,53 +228,53 @@ std::pair<std::vector<std::vector<std::pair<int, int>>>, PerformanceMetrics> dat
 }
 
 
-std::pair<std::vector<std::pair<int, int>>, PerformanceMetrics> dispatcher_benchmarked(py::array input, double ALPHA, int BLOCK_SIZE) {
+std::pair<std::vector<std::pair<int, int>>, PerformanceMetrics> dispatcher_benchmarked(CurveEngine& engine, py::array input, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
   // Check the data type (dtype) of the numpy array
   if (py::isinstance<py::array_t<uint8_t>>(input)) {
-    return data_driven_process_image<uint8_t>(input, ALPHA, BLOCK_SIZE);
+    return data_driven_process_image<uint8_t>(engine, input, ALPHA, BLOCK_SIZE, precision);
   }
   if (py::isinstance<py::array_t<uint16_t>>(input)) {
-    return data_driven_process_image<uint16_t>(input, ALPHA, BLOCK_SIZE);
+    return data_driven_process_image<uint16_t>(engine, input, ALPHA, BLOCK_SIZE, precision);
   }
   if (py::isinstance<py::array_t<float>>(input)) {
-    return data_driven_process_image<float>(input, ALPHA, BLOCK_SIZE);
+    return data_driven_process_image<float>(engine, input, ALPHA, BLOCK_SIZE, precision);
   }
   if (py::isinstance<py::array_t<double>>(input)) {
-    return data_driven_process_image<double>(input, ALPHA, BLOCK_SIZE);
+    return data_driven_process_image<double>(engine, input, ALPHA, BLOCK_SIZE, precision);
   }
   throw std::runtime_error("Unsupported data type! Please provide uint8, float32, or float64.");
 }
 
-std::pair<std::vector<std::vector<std::pair<int, int>>>, PerformanceMetrics> dispatcher_animation_benchmarked(py::array input, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy) {
+std::pair<std::vector<std::vector<std::pair<int, int>>>, PerformanceMetrics> dispatcher_animation_benchmarked(CurveEngine& engine, py::array input, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy, const std::string& precision) {
   // Check the data type (dtype) of the numpy array
   if (py::isinstance<py::array_t<uint8_t>>(input)) {
-    return data_driven_process_multiple_images<uint8_t>(input, ALPHA, BLOCK_SIZE, align_strategy);
+    return data_driven_process_multiple_images<uint8_t>(engine, input, ALPHA, BLOCK_SIZE, align_strategy, precision);
   }
   if (py::isinstance<py::array_t<uint16_t>>(input)) {
-    return data_driven_process_multiple_images<uint16_t>(input, ALPHA, BLOCK_SIZE, align_strategy);
+    return data_driven_process_multiple_images<uint16_t>(engine, input, ALPHA, BLOCK_SIZE, align_strategy, precision);
   }
   if (py::isinstance<py::array_t<float>>(input)) {
-    return data_driven_process_multiple_images<float>(input, ALPHA, BLOCK_SIZE, align_strategy);
+    return data_driven_process_multiple_images<float>(engine, input, ALPHA, BLOCK_SIZE, align_strategy, precision);
   }
   if (py::isinstance<py::array_t<double>>(input)) {
-    return data_driven_process_multiple_images<double>(input, ALPHA, BLOCK_SIZE, align_strategy);
+    return data_driven_process_multiple_images<double>(engine, input, ALPHA, BLOCK_SIZE, align_strategy, precision);
   }
   throw std::runtime_error("Unsupported data type! Please provide uint8, float32, or float64.");
 }
 
-std::vector<std::pair<int, int>> dispatcher(py::array input, double ALPHA, int BLOCK_SIZE) {
+std::vector<std::pair<int, int>> dispatcher(CurveEngine& engine, py::array input, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
   // Check the data type (dtype) of the numpy array
   if (py::isinstance<py::array_t<uint8_t>>(input)) {
-    return data_driven_process_image<uint8_t>(input, ALPHA, BLOCK_SIZE).first;
+    return data_driven_process_image<uint8_t>(engine, input, ALPHA, BLOCK_SIZE, precision).first;
   }
   if (py::isinstance<py::array_t<uint16_t>>(input)) {
-    return data_driven_process_image<uint16_t>(input, ALPHA, BLOCK_SIZE).first;
+    return data_driven_process_image<uint16_t>(engine, input, ALPHA, BLOCK_SIZE, precision).first;
   }
   if (py::isinstance<py::array_t<float>>(input)) {
-    return data_driven_process_image<float>(input, ALPHA, BLOCK_SIZE).first;
+    return data_driven_process_image<float>(engine, input, ALPHA, BLOCK_SIZE, precision).first;
   }
   if (py::isinstance<py::array_t<double>>(input)) {
-    return data_driven_process_image<double>(input, ALPHA, BLOCK_SIZE).first;
+    return data_driven_process_image<double>(engine, input, ALPHA, BLOCK_SIZE, precision).first;
   }
   throw std::runtime_error("Unsupported data type! Please provide uint8, float32, or float64.");
 }
@@ -200,23 +283,194 @@ std::vector<std::pair<int, int>> dispatcher(py::array input, double ALPHA, int B
 /**
  * Dispacher function exposed to python
  */
-std::vector<std::vector<std::pair<int, int>>> dispatcher_animation(py::array input, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy) {
+std::vector<std::vector<std::pair<int, int>>> dispatcher_animation(CurveEngine& engine, py::array input, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy, const std::string& precision) {
   // Check the data type (dtype) of the numpy array
   if (py::isinstance<py::array_t<uint8_t>>(input)) {
-    return data_driven_process_multiple_images<uint8_t>(input, ALPHA, BLOCK_SIZE, align_strategy).first;
+    return data_driven_process_multiple_images<uint8_t>(engine, input, ALPHA, BLOCK_SIZE, align_strategy, precision).first;
   }
   if (py::isinstance<py::array_t<uint16_t>>(input)) {
-    return data_driven_process_multiple_images<uint16_t>(input, ALPHA, BLOCK_SIZE, align_strategy).first;
+    return data_driven_process_multiple_images<uint16_t>(engine, input, ALPHA, BLOCK_SIZE, align_strategy, precision).first;
   }
   if (py::isinstance<py::array_t<float>>(input)) {
-    return data_driven_process_multiple_images<float>(input, ALPHA, BLOCK_SIZE, align_strategy).first;
+    return data_driven_process_multiple_images<float>(engine, input, ALPHA, BLOCK_SIZE, align_strategy, precision).first;
   }
   if (py::isinstance<py::array_t<double>>(input)) {
-    return data_driven_process_multiple_images<double>(input, ALPHA, BLOCK_SIZE, align_strategy).first;
+    return data_driven_process_multiple_images<double>(engine, input, ALPHA, BLOCK_SIZE, align_strategy, precision).first;
   }
   throw std::runtime_error("Unsupported data type! Please provide uint8, float32, or float64.");
 }
 
+std::vector<SweepResult> dispatcher_sweep(CurveEngine& engine, py::array input, const std::vector<std::pair<double, int>>& parameters, bool with_locality, int threads) {
+  // Check the data type (dtype) of the numpy array
+  if (py::isinstance<py::array_t<uint8_t>>(input)) {
+    return data_driven_process_sweep<uint8_t>(engine, input, parameters, with_locality, threads);
+  }
+  if (py::isinstance<py::array_t<uint16_t>>(input)) {
+    return data_driven_process_sweep<uint16_t>(engine, input, parameters, with_locality, threads);
+  }
+  if (py::isinstance<py::array_t<float>>(input)) {
+    return data_driven_process_sweep<float>(engine, input, parameters, with_locality, threads);
+  }
+  if (py::isinstance<py::array_t<double>>(input)) {
+    return data_driven_process_sweep<double>(engine, input, parameters, with_locality, threads);
+  }
+  throw std::runtime_error("Unsupported data type! Please provide uint8, float32, or float64.");
+}
+
+std::vector<std::pair<int, int>> dispatcher_pyramid(CurveEngine& engine, py::array input, double ALPHA, int BLOCK_SIZE, int levels) {
+  // Check the data type (dtype) of the numpy array
+  if (py::isinstance<py::array_t<uint8_t>>(input)) {
+    return data_driven_process_pyramid<uint8_t>(engine, input, ALPHA, BLOCK_SIZE, levels);
+  }
+  if (py::isinstance<py::array_t<uint16_t>>(input)) {
+    return data_driven_process_pyramid<uint16_t>(engine, input, ALPHA, BLOCK_SIZE, levels);
+  }
+  if (py::isinstance<py::array_t<float>>(input)) {
+    return data_driven_process_pyramid<float>(engine, input, ALPHA, BLOCK_SIZE, levels);
+  }
+  if (py::isinstance<py::array_t<double>>(input)) {
+    return data_driven_process_pyramid<double>(engine, input, ALPHA, BLOCK_SIZE, levels);
+  }
+  throw std::runtime_error("Unsupported data type! Please provide uint8, float32, or float64.");
+}
+
+std::vector<CurveComparison> dispatcher_comparison(CurveEngine& engine, py::array input, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
+  // Check the data type (dtype) of the numpy array
+  if (py::isinstance<py::array_t<uint8_t>>(input)) {
+    return data_driven_process_comparison<uint8_t>(engine, input, ALPHA, BLOCK_SIZE, precision);
+  }
+  if (py::isinstance<py::array_t<uint16_t>>(input)) {
+    return data_driven_process_comparison<uint16_t>(engine, input, ALPHA, BLOCK_SIZE, precision);
+  }
+  if (py::isinstance<py::array_t<float>>(input)) {
+    return data_driven_process_comparison<float>(engine, input, ALPHA, BLOCK_SIZE, precision);
+  }
+  if (py::isinstance<py::array_t<double>>(input)) {
+    return data_driven_process_comparison<double>(engine, input, ALPHA, BLOCK_SIZE, precision);
+  }
+  throw std::runtime_error("Unsupported data type! Please provide uint8, float32, or float64.");
+}
+
+py::bytes dispatcher_chain_code(CurveEngine& engine, py::array input, double ALPHA, int BLOCK_SIZE, const std::string& precision, uint32_t checkpoint_interval) {
+  std::vector<uint8_t> data;
+  // Check the data type (dtype) of the numpy array
+  if (py::isinstance<py::array_t<uint8_t>>(input)) {
+    data = data_driven_process_chain_code<uint8_t>(engine, input, ALPHA, BLOCK_SIZE, precision, checkpoint_interval);
+  } else if (py::isinstance<py::array_t<uint16_t>>(input)) {
+    data = data_driven_process_chain_code<uint16_t>(engine, input, ALPHA, BLOCK_SIZE, precision, checkpoint_interval);
+  } else if (py::isinstance<py::array_t<float>>(input)) {
+    data = data_driven_process_chain_code<float>(engine, input, ALPHA, BLOCK_SIZE, precision, checkpoint_interval);
+  } else if (py::isinstance<py::array_t<double>>(input)) {
+    data = data_driven_process_chain_code<double>(engine, input, ALPHA, BLOCK_SIZE, precision, checkpoint_interval);
+  } else {
+    throw std::runtime_error("Unsupported data type! Please provide uint8, float32, or float64.");
+  }
+  return py::bytes(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+/**
+ * Chain code helpers, encoded curves are exchanged as bytes-like objects
+ */
+py::bytes encode_chain_code(const std::vector<std::pair<int, int>>& path, int height, int width, uint32_t checkpoint_interval) {
+  auto data = chain_code::encode(path, height, width, checkpoint_interval);
+  return py::bytes(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+std::vector<std::pair<int, int>> decode_chain_code(py::buffer data) {
+  auto info = data.request();
+  // The decoder reads the bytes in place, so strided views are copied first
+  bool contiguous = true;
+  py::ssize_t stride = info.itemsize;
+  for(py::ssize_t d = info.ndim - 1; d >= 0; --d) {
+    contiguous = contiguous && (info.shape[d] == 1 || info.strides[d] == stride);
+    stride *= info.shape[d];
+  }
+  if(!contiguous) {
+    // Gather the items in C order, walking the strides like an odometer
+    std::vector<uint8_t> copy(static_cast<size_t>(info.size * info.itemsize));
+    std::vector<py::ssize_t> index(info.ndim, 0);
+    auto source = static_cast<const uint8_t*>(info.ptr);
+    for(py::ssize_t item = 0; item < info.size; ++item) {
+      py::ssize_t offset = 0;
+      for(py::ssize_t d = 0; d < info.ndim; ++d) {
+        offset += index[d] * info.strides[d];
+      }
+      std::memcpy(copy.data() + item * info.itemsize, source + offset, info.itemsize);
+      for(py::ssize_t d = info.ndim - 1; d >= 0 && ++index[d] == info.shape[d]; --d) {
+        index[d] = 0;
+      }
+    }
+    return chain_code::decode(copy.data(), copy.size());
+  }
+  return chain_code::decode(info.ptr, static_cast<size_t>(info.size * info.itemsize));
+}
+
+std::pair<int, int> chain_code_item(const chain_code::MappedChainCode& file, long long i) {
+  long long len = static_cast<long long>(file.get_view().size());
+  if(i < 0) {
+    i += len;
+  }
+  if(i < 0 || i >= len) {
+    throw py::index_error(std::format("Position {} is out of a path of {} pixels", i, len));
+  }
+  return file.get_view().at(static_cast<size_t>(i));
+}
+
+/**
+ * Cache consulted by the module-level entry points, disabled when null
+ */
+std::shared_ptr<CurveCache> module_cache;
+
+void set_curve_cache(std::shared_ptr<CurveCache> cache) {
+  module_cache = std::move(cache);
+}
+
+/**
+ * Engine shared by the module-level entry points of the calling thread, so
+ * repeated calls on same-shaped inputs reuse its buffers. Those buffers stay
+ * sized for the largest input seen; a CurveEngine object gives control over
+ * their lifetime.
+ */
+CurveEngine& module_engine(std::shared_ptr<CurveCache> cache) {
+  thread_local CurveEngine engine;
+  engine.set_cache(std::move(cache));
+  return engine;
+}
+
+/**
+ * Module-level entry points
+ */
+std::vector<std::pair<int, int>> image_traversal_path(py::array input, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
+  return dispatcher(module_engine(module_cache), input, ALPHA, BLOCK_SIZE, precision);
+}
+
+std::vector<std::vector<std::pair<int, int>>> multiple_images_traversal_path(py::array input, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy, const std::string& precision) {
+  return dispatcher_animation(module_engine(module_cache), input, ALPHA, BLOCK_SIZE, align_strategy, precision);
+}
+
+std::vector<SweepResult> image_traversal_path_sweep(py::array input, const std::vector<std::pair<double, int>>& parameters, bool with_locality, int threads) {
+  return dispatcher_sweep(module_engine(nullptr), input, parameters, with_locality, threads);
+}
+
+std::vector<std::pair<int, int>> image_traversal_path_pyramid(py::array input, double ALPHA, int BLOCK_SIZE, int levels) {
+  return dispatcher_pyramid(module_engine(module_cache), input, ALPHA, BLOCK_SIZE, levels);
+}
+
+std::vector<CurveComparison> traversal_path_comparison(py::array input, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
+  return dispatcher_comparison(module_engine(nullptr), input, ALPHA, BLOCK_SIZE, precision);
+}
+
+py::bytes image_traversal_chain_code(py::array input, double ALPHA, int BLOCK_SIZE, const std::string& precision, uint32_t checkpoint_interval) {
+  return dispatcher_chain_code(module_engine(module_cache), input, ALPHA, BLOCK_SIZE, precision, checkpoint_interval);
+}
+
+std::pair<std::vector<std::pair<int, int>>, PerformanceMetrics> image_traversal_path_benchmarked(py::array input, double ALPHA, int BLOCK_SIZE, const std::string& precision) {
+  return dispatcher_benchmarked(module_engine(module_cache), input, ALPHA, BLOCK_SIZE, precision);
+}
+
+std::pair<std::vector<std::vector<std::pair<int, int>>>, PerformanceMetrics> multiple_images_traversal_path_benchmarked(py::array input, double ALPHA, int BLOCK_SIZE, const std::string& align_strategy, const std::string& precision) {
+  return dispatcher_animation_benchmarked(module_engine(module_cache), input, ALPHA, BLOCK_SIZE, align_strategy, precision);
+}
 
 /**
  * Binding to python module
@@ -229,19 +483,234 @@ PYBIND11_MODULE(data_driven_module, m) {
       .def_readonly("total_cpp_time_ms", &PerformanceMetrics::total_cpp_time_ms);
     
     // Exposed python function names
-    m.def("get_image_traversal_path", &dispatcher, "Calculate traversal path for generic arrays");
-    m.def("get_multiple_images_traversal_path", &dispatcher_animation,
+    m.def("get_image_traversal_path", &image_traversal_path,
+      "Calculate traversal path for generic arrays",
+      py::arg("input"),
+      py::arg("ALPHA"),
+      py::arg("BLOCK_SIZE"),
+      py::arg("precision") = "double");
+    m.def("get_multiple_images_traversal_path", &multiple_images_traversal_path,
       "Calculate traversal path for multiple generic arrays",
       py::arg("input"),
       py::arg("ALPHA"),
       py::arg("BLOCK_SIZE"),
-      py::arg("align_strategy") = "None");
+      py::arg("align_strategy") = "None",
+      py::arg("precision") = "double");
 
-    m.def("get_image_traversal_path_benchmarked", &dispatcher_benchmarked, "Calculate traversal path for generic arrays with benchmarks");
-    m.def("get_multiple_images_traversal_path_benchmarked", &dispatcher_animation_benchmarked,
+    m.def("get_image_traversal_path_benchmarked", &image_traversal_path_benchmarked,
+      "Calculate traversal path for generic arrays with benchmarks",
+      py::arg("input"),
+      py::arg("ALPHA"),
+      py::arg("BLOCK_SIZE"),
+      py::arg("precision") = "double");
+    m.def("get_multiple_images_traversal_path_benchmarked", &multiple_images_traversal_path_benchmarked,
       "Calculate traversal path for multiple generic arrays with benchmarks", 
       py::arg("input"),
       py::arg("ALPHA"),
       py::arg("BLOCK_SIZE"),
-      py::arg("align_strategy") = "None");
+      py::arg("align_strategy") = "None",
+      py::arg("precision") = "double");
+
+    py::class_<SweepResult>(m, "SweepResult")
+      .def_readonly("ALPHA", &SweepResult::ALPHA)
+      .def_readonly("BLOCK_SIZE", &SweepResult::BLOCK_SIZE)
+      .def_readonly("path", &SweepResult::path)
+      .def_readonly("locality_score", &SweepResult::locality_score);
+
+    m.def("get_image_traversal_path_sweep", &image_traversal_path_sweep,
+      "Calculate traversal paths of one array for many (ALPHA, BLOCK_SIZE) pairs",
+      py::arg("input"),
+      py::arg("parameters"),
+      py::arg("with_locality") = false,
+      py::arg("threads") = 0);
+
+    m.def("get_image_traversal_path_pyramid", &image_traversal_path_pyramid,
+      "Calculate traversal path for generic arrays coarse to fine, levels=0 is the exact curve",
+      py::arg("input"),
+      py::arg("ALPHA"),
+      py::arg("BLOCK_SIZE"),
+      py::arg("levels") = 2);
+    m.def("get_image_traversal_chain_code", &image_traversal_chain_code,
+      "Calculate traversal path for generic arrays, packed as a 2-bit chain code",
+      py::arg("input"),
+      py::arg("ALPHA"),
+      py::arg("BLOCK_SIZE"),
+      py::arg("precision") = "double",
+      py::arg("checkpoint_interval") = chain_code::DEFAULT_CHECKPOINT_INTERVAL);
+    m.def("encode_chain_code", &encode_chain_code,
+      "Pack a traversal path as a 2-bit chain code",
+      py::arg("path"),
+      py::arg("height"),
+      py::arg("width"),
+      py::arg("checkpoint_interval") = chain_code::DEFAULT_CHECKPOINT_INTERVAL);
+    m.def("decode_chain_code", &decode_chain_code,
+      "Unpack a chain code from a bytes-like object into a traversal path",
+      py::arg("data"));
+
+    py::class_<chain_code::MappedChainCode>(m, "ChainCodeFile",
+      "Memory mapped chain code file with random access to the curve positions")
+      .def(py::init<const std::string&>(), py::arg("filename"))
+      .def("__len__", [](const chain_code::MappedChainCode& file) { return file.get_view().size(); })
+      .def("__getitem__", &chain_code_item)
+      .def("decode", [](const chain_code::MappedChainCode& file, size_t start, size_t stop) {
+          return file.get_view().decode(start, stop);
+        },
+        "Decode the pixels at positions [start, stop)",
+        py::arg("start") = 0,
+        py::arg("stop") = std::numeric_limits<size_t>::max())
+      .def_property_readonly("height", [](const chain_code::MappedChainCode& file) { return file.get_view().get_header().height; })
+      .def_property_readonly("width", [](const chain_code::MappedChainCode& file) { return file.get_view().get_header().width; })
+      .def_property_readonly("start", [](const chain_code::MappedChainCode& file) {
+          auto& header = file.get_view().get_header();
+          return std::make_pair(header.start_row, header.start_col);
+        })
+      .def_property_readonly("clockwise", [](const chain_code::MappedChainCode& file) {
+          return file.get_view().get_header().orientation == chain_code::CLOCKWISE;
+        });
+
+    m.def("get_hilbert_traversal_path", &baseline_curves::hilbert,
+      "Hilbert curve of a height x width grid, generalized to any shape",
+      py::arg("height"),
+      py::arg("width"));
+    m.def("get_morton_traversal_path", &baseline_curves::morton,
+      "Z-order (Morton) curve of a height x width grid",
+      py::arg("height"),
+      py::arg("width"));
+    m.def("get_snake_traversal_path", &baseline_curves::snake,
+      "Row by row boustrophedon curve of a height x width grid",
+      py::arg("height"),
+      py::arg("width"));
+
+    py::class_<CurveComparison>(m, "CurveComparison")
+      .def_readonly("name", &CurveComparison::name)
+      .def_readonly("path", &CurveComparison::path)
+      .def_readonly("build_time_ms", &CurveComparison::build_time_ms)
+      .def_readonly("locality_score", &CurveComparison::locality_score)
+      .def_readonly("delta_entropy", &CurveComparison::delta_entropy)
+      .def_readonly("mean_step_length", &CurveComparison::mean_step_length);
+
+    m.def("compare_traversal_paths", &traversal_path_comparison,
+      "Build the data driven, Hilbert, Morton and snake curves of an array and measure each of them",
+      py::arg("input"),
+      py::arg("ALPHA"),
+      py::arg("BLOCK_SIZE"),
+      py::arg("precision") = "double");
+
+    py::class_<CurveIndex>(m, "CurveIndex",
+      "Range-query index answering which curve intervals cover a rectangle")
+      .def(py::init<const std::vector<std::pair<int, int>>&, int, int>(),
+        py::arg("path"),
+        py::arg("height"),
+        py::arg("width"))
+      .def("query", &CurveIndex::query,
+        "Sorted half-open curve intervals covering rows [row_begin, row_end) and cols [col_begin, col_end)",
+        py::arg("row_begin"),
+        py::arg("row_end"),
+        py::arg("col_begin"),
+        py::arg("col_end"),
+        py::arg("offset") = 0)
+      .def("bounds", &CurveIndex::bounds,
+        "Single half-open curve interval spanning every pixel of the rectangle",
+        py::arg("row_begin"),
+        py::arg("row_end"),
+        py::arg("col_begin"),
+        py::arg("col_end"))
+      .def("rank", &CurveIndex::rank, "Position of pixel (x, y) along the curve", py::arg("x"), py::arg("y"))
+      .def_property_readonly("height", &CurveIndex::get_height)
+      .def_property_readonly("width", &CurveIndex::get_width);
+
+    py::class_<AnimationIndex>(m, "AnimationIndex",
+      "Range-query index over the curves of an animation stored frame after frame")
+      .def(py::init<const std::vector<std::vector<std::pair<int, int>>>&, int, int>(),
+        py::arg("paths"),
+        py::arg("height"),
+        py::arg("width"))
+      .def("query", &AnimationIndex::query,
+        "Sorted half-open intervals covering the rectangle in frames [frame_begin, frame_end)",
+        py::arg("row_begin"),
+        py::arg("row_end"),
+        py::arg("col_begin"),
+        py::arg("col_end"),
+        py::arg("frame_begin"),
+        py::arg("frame_end"))
+      .def("__len__", &AnimationIndex::size);
+
+    py::class_<CurveCache, std::shared_ptr<CurveCache>>(m, "CurveCache",
+      "Content-addressed cache of curves with an in-memory LRU tier and an optional on-disk tier")
+      .def(py::init<size_t, std::string, size_t>(),
+        py::arg("max_entries") = 256,
+        py::arg("directory") = "",
+        py::arg("max_bytes") = CurveCache::DEFAULT_MAX_BYTES)
+      .def("clear", &CurveCache::clear, "Drop the in-memory tier, files on disk are kept")
+      .def("__len__", &CurveCache::size)
+      .def_property_readonly("bytes", &CurveCache::get_bytes, "Bytes of path data held by the in-memory tier")
+      .def_property_readonly("hits", &CurveCache::get_hits)
+      .def_property_readonly("misses", &CurveCache::get_misses);
+
+    m.def("set_curve_cache", &set_curve_cache,
+      "Set the cache consulted by the module-level traversal functions, None disables it",
+      py::arg("cache").none(true));
+
+    py::class_<CurveEngine>(m, "CurveEngine",
+      "Long-lived workspace that reuses its buffers across same-shaped inputs")
+      .def(py::init<>())
+      .def(py::init<int, int, int>(),
+        py::arg("height"),
+        py::arg("width"),
+        py::arg("channels") = 1)
+      .def_property_readonly("height", &CurveEngine::get_height)
+      .def_property_readonly("width", &CurveEngine::get_width)
+      .def_property_readonly("channels", &CurveEngine::get_channels)
+      .def_property("cache", &CurveEngine::get_cache, &CurveEngine::set_cache)
+      .def("get_image_traversal_path", &dispatcher,
+        "Calculate traversal path for generic arrays",
+        py::arg("input"),
+        py::arg("ALPHA"),
+        py::arg("BLOCK_SIZE"),
+        py::arg("precision") = "double")
+      .def("get_multiple_images_traversal_path", &dispatcher_animation,
+        "Calculate traversal path for multiple generic arrays",
+        py::arg("input"),
+        py::arg("ALPHA"),
+        py::arg("BLOCK_SIZE"),
+        py::arg("align_strategy") = "None",
+        py::arg("precision") = "double")
+      .def("get_image_traversal_path_benchmarked", &dispatcher_benchmarked,
+        "Calculate traversal path for generic arrays with benchmarks",
+        py::arg("input"),
+        py::arg("ALPHA"),
+        py::arg("BLOCK_SIZE"),
+        py::arg("precision") = "double")
+      .def("get_multiple_images_traversal_path_benchmarked", &dispatcher_animation_benchmarked,
+        "Calculate traversal path for multiple generic arrays with benchmarks",
+        py::arg("input"),
+        py::arg("ALPHA"),
+        py::arg("BLOCK_SIZE"),
+        py::arg("align_strategy") = "None",
+        py::arg("precision") = "double")
+      .def("get_image_traversal_path_pyramid", &dispatcher_pyramid,
+        "Calculate traversal path for generic arrays coarse to fine, levels=0 is the exact curve",
+        py::arg("input"),
+        py::arg("ALPHA"),
+        py::arg("BLOCK_SIZE"),
+        py::arg("levels") = 2)
+      .def("get_image_traversal_chain_code", &dispatcher_chain_code,
+        "Calculate traversal path for generic arrays, packed as a 2-bit chain code",
+        py::arg("input"),
+        py::arg("ALPHA"),
+        py::arg("BLOCK_SIZE"),
+        py::arg("precision") = "double",
+        py::arg("checkpoint_interval") = chain_code::DEFAULT_CHECKPOINT_INTERVAL)
+      .def("compare_traversal_paths", &dispatcher_comparison,
+        "Build the data driven, Hilbert, Morton and snake curves of an array and measure each of them",
+        py::arg("input"),
+        py::arg("ALPHA"),
+        py::arg("BLOCK_SIZE"),
+        py::arg("precision") = "double")
+      .def("get_image_traversal_path_sweep", &dispatcher_sweep,
+        "Calculate traversal paths of one array for many (ALPHA, BLOCK_SIZE) pairs",
+        py::arg("input"),
+        py::arg("parameters"),
+        py::arg("with_locality") = false,
+        py::arg("threads") = 0);
 }
\ No newline at end of file
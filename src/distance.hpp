@@ -1,5 +1,6 @@
 #ifndef DISTANCE_H
 #define DISTANCE_H
+#include <vector>
 #include "util.hpp"
 /**
  * @brief Base class for calculating distances during prim's algorithm.
@@ -13,7 +14,8 @@ class Distance {
 public:
   /**
    * @brief Constructs the Distance calculator.
-   * @param grid A const reference to the 3D grid data [x][y][channel].
+   * @param grid A const reference to the 3D grid data [x][y][channel]. The grid
+   * is not copied, so it must outlive the Distance object.
    */
   Distance(const std::vector<std::vector<std::vector<grid_type>>>& grid) : grid { grid } {};
   /**
@@ -27,7 +29,7 @@ public:
    */
   virtual distance_type get_distance(std::pair<int, int> id_a, std::pair<int, int> id_b) const = 0;
 protected:
-  std::vector<std::vector<std::vector<grid_type>>> grid;
+  const std::vector<std::vector<std::vector<grid_type>>>& grid;
 };
 
 #endif // !DISTANCE_H
\ No newline at end of file
@@ -13,6 +13,10 @@ struct DisjointSetUnion {
   
   DisjointSetUnion(int n) : p(n, -1) {} 
   
+  void reset(int n) { 
+    p.assign(n, -1); 
+  } 
+  
   int root(int a) { 
     return p[a] < 0 ? a : p[a] = root(p[a]); 
   } 
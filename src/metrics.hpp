@@ -0,0 +1,100 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <vector>
+#include <utility>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_map>
+#include <type_traits>
+
+/**
+ * @namespace metrics
+ * @brief A namespace with quality measures of a traversal path over an image.
+ */
+namespace metrics {
+
+/**
+ * @brief Locality score of a path: the mean L1 pixel difference between
+ * consecutive pixels of the traversal. Lower is better.
+ */
+template<typename T>
+double locality_score(const std::vector<std::vector<std::vector<T>>>& image, const std::vector<std::pair<int, int>>& path) {
+  if(path.size() < 2) {
+    return 0;
+  }
+  double total = 0;
+  for(size_t i = 1, len = path.size(); i < len; ++i) {
+    auto& u = image[path[i - 1].first][path[i - 1].second];
+    auto& v = image[path[i].first][path[i].second];
+    for(size_t k = 0, channels = u.size(); k < channels; ++k) {
+      total += std::abs(static_cast<double>(u[k]) - static_cast<double>(v[k]));
+    }
+  }
+  return total / static_cast<double>(path.size() - 1);
+}
+
+/**
+ * @brief Mean L1 length of the steps of a path, 1 for curves that only move
+ * to 4-neighbours. Jumps make it grow.
+ */
+inline double mean_step_length(const std::vector<std::pair<int, int>>& path) {
+  if(path.size() < 2) {
+    return 0;
+  }
+  double total = 0;
+  for(size_t i = 1, len = path.size(); i < len; ++i) {
+    total += std::abs(path[i].first - path[i - 1].first) + std::abs(path[i].second - path[i - 1].second);
+  }
+  return total / static_cast<double>(path.size() - 1);
+}
+
+/**
+ * @brief Compressibility of the image linearized along a path: the zeroth-order
+ * entropy, in bits per value, of the differences between consecutive pixels.
+ * @details It estimates the size of a delta coded stream, lower is better.
+ * Integral images use the exact differences; floating images are first
+ * quantized to 256 levels over their value range.
+ */
+template<typename T>
+double delta_entropy(const std::vector<std::vector<std::vector<T>>>& image, const std::vector<std::pair<int, int>>& path) {
+  if(path.size() < 2) {
+    return 0;
+  }
+  double lo = 0, scale = 1;
+  if constexpr (std::is_floating_point_v<T>) {
+    double hi = lo = static_cast<double>(image[path[0].first][path[0].second][0]);
+    for(const auto& [x, y] : path) {
+      for(auto value : image[x][y]) {
+        lo = std::min(lo, static_cast<double>(value));
+        hi = std::max(hi, static_cast<double>(value));
+      }
+    }
+    scale = hi > lo ? 255 / (hi - lo) : 1;
+  }
+  auto level = [&](T value) {
+    return static_cast<int64_t>(std::llround((static_cast<double>(value) - lo) * scale));
+  };
+
+  std::unordered_map<int64_t, size_t> counts;
+  size_t total = 0;
+  for(size_t i = 1, len = path.size(); i < len; ++i) {
+    auto& u = image[path[i - 1].first][path[i - 1].second];
+    auto& v = image[path[i].first][path[i].second];
+    for(size_t k = 0, channels = u.size(); k < channels; ++k) {
+      counts[level(v[k]) - level(u[k])] += 1;
+      total += 1;
+    }
+  }
+  double entropy = 0;
+  for(const auto& [delta, count] : counts) {
+    double p = static_cast<double>(count) / static_cast<double>(total);
+    entropy -= p * std::log2(p);
+  }
+  return entropy;
+}
+
+}
+
+#endif // !METRICS_H
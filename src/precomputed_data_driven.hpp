@@ -0,0 +1,42 @@
+#ifndef PRECOMPUTED_DATA_DRIVEN_H
+#define PRECOMPUTED_DATA_DRIVEN_H
+#include "data_driven.hpp"
+
+/**
+ * @brief Data Driven distance that reads the adjacency term from a shared table.
+ * @details The table comes from DataDrivenDistance::adj_edge_costs and only
+ * depends on the image, so it can be computed once and shared by runs with
+ * different ALPHA and BLOCK values. The distances are bit-identical to
+ * DataDrivenDistance for the same parameters.
+ *
+ * @tparam distance_type the numerical type for distances, float or double.
+ * @tparam grid_type the numerical type of each color channel on each position
+ * of the grid.
+ */
+template<typename distance_type, typename grid_type>
+class PrecomputedDataDrivenDistance : public DataDrivenDistance<distance_type, grid_type> {
+public:
+  /**
+   * @brief Constructs the precomputed Data Driven Distance calculator.
+   * @param grid A const reference to the 3D grid data [x][y][channel].
+   * @param adj_costs The table returned by DataDrivenDistance::adj_edge_costs for grid.
+   * It is not copied, so it must outlive this object.
+   * @param ALPHA An auxiliary weight value between 0-1 for distance calculation
+   * @param BLOCK The small circuits are divided into blocks of size BLOCK x BLOCK
+   */
+  PrecomputedDataDrivenDistance(const std::vector<std::vector<std::vector<grid_type>>>& grid, const std::vector<distance_type>& adj_costs, distance_type ALPHA, int BLOCK) :
+    DataDrivenDistance<distance_type, grid_type>{grid, ALPHA, BLOCK},
+    adj_costs { adj_costs },
+    node_c { grid.empty() ? 0 : static_cast<int>(grid[0].size()) / 2 }
+  {}
+
+  distance_type get_distance(std::pair<int, int> id_a, std::pair<int, int> id_b) const override {
+    auto adj = adj_costs[(static_cast<size_t>(id_a.first) * node_c + id_a.second) * 4 + util::get_direction(id_a, id_b)];
+    return (1 - this->ALPHA) * adj + this->ALPHA * this->block_edge_cost(id_b);
+  }
+private:
+  const std::vector<distance_type>& adj_costs;
+  int node_c;
+};
+
+#endif // !PRECOMPUTED_DATA_DRIVEN_H
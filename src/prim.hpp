@@ -2,24 +2,62 @@
 #define PRIM_HPP
 
 #include <vector>
-#include <set>
-#include <queue>        // std::priority_queue
+#include <algorithm>    // std::push_heap, std::pop_heap
 #include <tuple>        // std::tuple
 #include <utility>      // std::pair, std::make_pair
 #include <limits>       // std::numeric_limits
 #include <functional>   // std::greater
 #include <format>       // std::format
 #include <stdexcept>    // std::runtime_error
+#include <cstdint>      // uint8_t
+#include <bit>          // std::popcount
 
 // Custom headers
 #include "dsu.hpp"
 #include "util.hpp"
 #include "distance.hpp"
+#include "chain_code.hpp"
+
+/**
+ * @brief Buffers used by a single Prim's algorithm execution.
+ * @details Every buffer is flat and is only resized when the grid shape grows,
+ * so a workspace kept alive between runs makes them allocation-free.
+ *
+ * @tparam distance_type The numerical type for distances (e.g., float, double).
+ */
+template<typename distance_type>
+struct PrimWorkspace {
+  std::vector<uint8_t> adj;                // Pixel adjacency graph, bit i is set if (x + DIR_X[i], y + DIR_Y[i]) is a neighbour
+  std::vector<int> par;                    // Parent node of each node, -1 for the root
+  std::vector<distance_type> min_w;        // Best known cost to reach each node
+  std::vector<uint8_t> is_selected;        // Whether each node is already in the tree
+  std::vector<std::tuple<distance_type, int, int>> heap; // Min-heap of (cost, x, y)
+  std::vector<uint8_t> is_visited;         // Pixels already emitted by the path walk
+  DisjointSetUnion dsu{0};
+
+  /**
+   * @brief Reserves every buffer for a r x c pixel grid.
+   */
+  void reserve(int r, int c) {
+    int nodes = (r / 2) * (c / 2);
+    adj.reserve(r * c);
+    par.reserve(nodes);
+    min_w.reserve(nodes);
+    is_selected.reserve(nodes);
+    heap.reserve(2 * nodes + 1);
+    is_visited.reserve(r * c);
+    dsu.p.reserve(r * c);
+  }
+};
 
 /**
  * @brief A class to run Prim's algorithm on a grid of nodes,
  * modifying an underlying pixel graph to create a space-filling curve.
  *
+ * Ties between equal costs are broken by the smallest (row, col) node id,
+ * so narrower distance types (float, fixed-point) only change the curve when
+ * rounding creates or removes a tie.
+ *
  * @tparam distance_type The numerical type for distances (e.g., float, double).
  * @tparam grid_type The numerical type of the grid data (e.g., int, float).
  * Ideally, it should be the same as distance_type.
@@ -28,19 +66,28 @@ template<typename distance_type, typename grid_type>
 class Prim {
 public:
   /**
-   * @brief Constructs the Prim algorithm runner.
+   * @brief Constructs the Prim algorithm runner with its own buffers.
    * @param r The number of rows in the pixel grid.
    * @param c The number of columns in the pixel grid.
    */
-  Prim(int r, int c) :
-    r { r }, 
-    c { c }, 
-    node_r { r / 2 }, 
+  Prim(int r, int c) : Prim(r, c, owned_workspace) {}
+
+  /**
+   * @brief Constructs the Prim algorithm runner on top of a borrowed workspace.
+   * @param r The number of rows in the pixel grid.
+   * @param c The number of columns in the pixel grid.
+   * @param workspace Buffers that outlive this runner and are reused across runs.
+   */
+  Prim(int r, int c, PrimWorkspace<distance_type>& workspace) :
+    r { r },
+    c { c },
+    node_r { r / 2 },
     node_c { c / 2 },
-    adj(r, std::vector<std::set<std::pair<int, int>>>(c))
-  {
-    initial_adj(); // Build the initial graph
-  }
+    ws { workspace }
+  {}
+
+  Prim(const Prim&) = delete;
+  Prim& operator=(const Prim&) = delete;
 
   /**
    * @brief Runs Prim's algorithm to generate the space-filling curve.
@@ -52,73 +99,217 @@ public:
    */
   std::vector<std::pair<int, int>> run(const Distance<distance_type, grid_type>& dist_calc);
 
+  /**
+   * @brief Same as run, but writes the curve into pixel_order.
+   * @details pixel_order is cleared and refilled, so passing the same vector
+   * on every run together with a workspace makes the run allocation-free.
+   */
+  void run(const Distance<distance_type, grid_type>& dist_calc, std::vector<std::pair<int, int>>& pixel_order);
+
+  /**
+   * @brief Runs Prim's algorithm and emits the curve in the chain code format.
+   * @details The path walk feeds the encoder directly, so the list of pixel
+   * coordinates is never materialized. Decoding the result gives run's path.
+   *
+   * @param checkpoint_interval Steps between random access checkpoints, see chain_code.
+   */
+  std::vector<uint8_t> run_chain_code(const Distance<distance_type, grid_type>& dist_calc, uint32_t checkpoint_interval = chain_code::DEFAULT_CHECKPOINT_INTERVAL);
+
+  /**
+   * @brief Computes the minimum spanning tree of the node grid, without building the curve.
+   * @return The parent of each node x * node_c + y, -1 for the root (0, 0).
+   */
+  std::vector<int> spanning_tree(const Distance<distance_type, grid_type>& dist_calc);
+
+  /**
+   * @brief Builds the curve of a given spanning tree of the node grid.
+   * @details Any spanning tree gives a valid curve, e.g. one refined from a
+   * coarser level by pyramid::PyramidPrim.
+   *
+   * @param parent The parent of each node x * node_c + y, -1 for the root.
+   */
+  std::vector<std::pair<int, int>> run(const std::vector<int>& parent);
+
 private:
   int r, c;           // Pixel grid dimensions
   int node_r, node_c; // Node grid dimensions
-  std::vector<std::vector<std::set<std::pair<int, int>>>> adj; // Pixel adjacency graph
+  PrimWorkspace<distance_type> owned_workspace;
+  PrimWorkspace<distance_type>& ws;
 
   /**
-   * @brief Helper to add an undirected edge to the member 'adj' graph.
+   * @brief Helper to add an undirected edge to the workspace 'adj' graph.
    */
   void add_edge(std::pair<int, int> a, std::pair<int, int> b);
 
+  /**
+   * @brief Helper to remove an undirected edge from the workspace 'adj' graph.
+   */
+  void remove_edge(std::pair<int, int> a, std::pair<int, int> b);
+
   /**
    * @brief Creates the initial pixel adjacency list for all small circuits.
    */
   void initial_adj();
+
+  /**
+   * @brief Merges the small circuit of node id into the one of its tree parent id_par.
+   */
+  void merge(std::pair<int, int> id_par, std::pair<int, int> id);
+
+  /**
+   * @brief Grows the minimum spanning tree from node (0, 0) into 'par',
+   * merging every selected node into its parent.
+   */
+  void select_tree(const Distance<distance_type, grid_type>& dist_calc);
+
+  /**
+   * @brief Throws unless 'adj' is a single cycle over every pixel.
+   */
+  void check_cycle();
+
+  /**
+   * @brief Merges the small circuits along the minimum spanning tree and
+   * checks that 'adj' ends up as a single cycle.
+   */
+  void build_cycle(const Distance<distance_type, grid_type>& dist_calc);
+
+  /**
+   * @brief Walks the cycle from (0, 0), calling visit(pixel, direction) on every
+   * pixel, where direction leads from the previous pixel and is -1 for the first one.
+   */
+  template<typename Visitor>
+  void walk(Visitor&& visit);
 };
 
 template<typename distance_type, typename grid_type>
 std::vector<std::pair<int, int>> Prim<distance_type, grid_type>::run(const Distance<distance_type, grid_type>& dist_calc) {
-  std::vector par(node_r, std::vector<std::pair<int, int>>(node_c, std::make_pair(-1, -1)));
-  
+  std::vector<std::pair<int, int>> pixel_order;
+  run(dist_calc, pixel_order);
+  return pixel_order;
+}
+
+template<typename distance_type, typename grid_type>
+void Prim<distance_type, grid_type>::run(const Distance<distance_type, grid_type>& dist_calc, std::vector<std::pair<int, int>>& pixel_order) {
+  build_cycle(dist_calc);
+  pixel_order.clear();
+  pixel_order.reserve(r * c);
+  walk([&](std::pair<int, int> pixel, int) { pixel_order.emplace_back(pixel); });
+}
+
+template<typename distance_type, typename grid_type>
+std::vector<int> Prim<distance_type, grid_type>::spanning_tree(const Distance<distance_type, grid_type>& dist_calc) {
+  initial_adj();
+  select_tree(dist_calc);
+  return ws.par;
+}
+
+template<typename distance_type, typename grid_type>
+std::vector<std::pair<int, int>> Prim<distance_type, grid_type>::run(const std::vector<int>& parent) {
+  if(parent.size() != static_cast<size_t>(node_r) * node_c) {
+    throw std::runtime_error(std::format(
+      "Spanning tree has {} nodes, expected {}.",
+      parent.size(), node_r * node_c
+    ));
+  }
+  initial_adj();
+  for(int node = 0, nodes = node_r * node_c; node < nodes; ++node) {
+    if(parent[node] == -1) continue;
+    std::pair<int, int> id_par = {parent[node] / node_c, parent[node] % node_c}, id = {node / node_c, node % node_c};
+    if(parent[node] < 0 || parent[node] >= nodes || util::get_direction(id_par, id) == -1) {
+      throw std::runtime_error(std::format(
+        "Spanning tree edge ({}, {}) -> ({}, {}) does not join adjacent nodes.",
+        id_par.first, id_par.second, id.first, id.second
+      ));
+    }
+    merge(id_par, id);
+  }
+  check_cycle();
+  std::vector<std::pair<int, int>> pixel_order;
+  pixel_order.reserve(r * c);
+  walk([&](std::pair<int, int> pixel, int) { pixel_order.emplace_back(pixel); });
+  return pixel_order;
+}
+
+template<typename distance_type, typename grid_type>
+std::vector<uint8_t> Prim<distance_type, grid_type>::run_chain_code(const Distance<distance_type, grid_type>& dist_calc, uint32_t checkpoint_interval) {
+  build_cycle(dist_calc);
+  chain_code::Encoder encoder(r, c, {0, 0}, static_cast<uint64_t>(r) * c, checkpoint_interval);
+  walk([&](std::pair<int, int>, int direction) {
+    if(direction != -1) {
+      encoder.push(direction);
+    }
+  });
+  return encoder.finish();
+}
+
+template<typename distance_type, typename grid_type>
+void Prim<distance_type, grid_type>::build_cycle(const Distance<distance_type, grid_type>& dist_calc) {
+  initial_adj(); // Build the initial graph
+  select_tree(dist_calc);
+  check_cycle();
+}
+
+template<typename distance_type, typename grid_type>
+void Prim<distance_type, grid_type>::select_tree(const Distance<distance_type, grid_type>& dist_calc) {
+  auto& par = ws.par;
+  auto& min_w = ws.min_w;
+  auto& is_selected = ws.is_selected;
+  par.assign(node_r * node_c, -1);
+  min_w.assign(node_r * node_c, std::numeric_limits<distance_type>::max());
+  is_selected.assign(node_r * node_c, false);
+
   using iii = std::tuple<distance_type, int, int>;
-  std::priority_queue<iii, std::vector<iii>, std::greater<iii>> pq;
-  std::vector min_w(node_r, std::vector<distance_type>(node_c, std::numeric_limits<distance_type>::max()));
-  std::vector is_selected(node_r, std::vector<bool>(node_c, false));
+  // Each node edge is relaxed at most once, so the heap never outgrows this buffer
+  auto& pq = ws.heap;
+  pq.clear();
+  pq.reserve(2 * node_r * node_c + 1);
+  auto push = [&](distance_type d, int x, int y) {
+    pq.emplace_back(d, x, y);
+    std::push_heap(pq.begin(), pq.end(), std::greater<iii>{});
+  };
   int select_count = 0;
 
-  pq.emplace(min_w[0][0] = 0, 0, 0);
+  push(min_w[0] = 0, 0, 0);
   while(!pq.empty()) {
-    auto [d, id_x, id_y] = pq.top();
-    pq.pop();
+    std::pop_heap(pq.begin(), pq.end(), std::greater<iii>{});
+    auto [d, id_x, id_y] = pq.back();
+    pq.pop_back();
     std::pair<int, int> id = {id_x, id_y};
-    
-    if(is_selected[id_x][id_y]) continue;
-    is_selected[id_x][id_y] = true;
+    int node = id_x * node_c + id_y;
+
+    if(is_selected[node]) continue;
+    is_selected[node] = true;
     select_count += 1;
-    
-    auto id_par = par[id_x][id_y];
-    if(id_par.first != -1) {
+
+    if(par[node] != -1) {
       // Not the root, join it to its parent
-      for(auto [u, v] : util::get_removed_edges(id_par, id)) {
-        adj[u.first][u.second].erase(v);
-        adj[v.first][v.second].erase(u);
-      }
-      for(auto [u, v] : util::get_added_edges(id_par, id)) {
-        add_edge(u, v);
-      }
+      merge({par[node] / node_c, par[node] % node_c}, id);
     }
 
     for(int i = 0; i < 4; ++i) {
       int id_nx = id_x + util::DIR_X[i], id_ny = id_y + util::DIR_Y[i];
-      if(id_nx < 0 || id_ny < 0 || id_nx >= node_r || id_ny >= node_c || is_selected[id_nx][id_ny]) continue;
-      
+      if(id_nx < 0 || id_ny < 0 || id_nx >= node_r || id_ny >= node_c) continue;
+      int next = id_nx * node_c + id_ny;
+      if(is_selected[next]) continue;
+
       auto cost = dist_calc.get_distance({id_x, id_y}, {id_nx, id_ny});
 
-      if(min_w[id_nx][id_ny] > cost) {
-        pq.emplace(min_w[id_nx][id_ny] = cost, id_nx, id_ny);
-        par[id_nx][id_ny] = {id_x, id_y};
+      if(min_w[next] > cost) {
+        push(min_w[next] = cost, id_nx, id_ny);
+        par[next] = node;
       }
     }
   }
+}
 
+template<typename distance_type, typename grid_type>
+void Prim<distance_type, grid_type>::check_cycle() {
   // Debug logic to see if it generated an actual space-filling curve
 
   int lo = 5, hi = 0;
   for(int x = 0; x < r; ++x) {
     for(int y = 0; y < c; ++y) {
-      int sz = (int)adj[x][y].size();
+      int sz = std::popcount(ws.adj[x * c + y]);
       lo = std::min(lo, sz);
       hi = std::max(hi, sz);
     }
@@ -126,19 +317,20 @@ std::vector<std::pair<int, int>> Prim<distance_type, grid_type>::run(const Dista
   if (lo != 2 || hi != 2) {
     throw std::runtime_error(std::format(
       "Topology Error: Generated graph is not a valid cycle.\n"
-      "Expected degree 2. Found min_degree={}, max_degree={}.", 
+      "Expected degree 2. Found min_degree={}, max_degree={}.",
       lo, hi
     ));
   }
 
-  DisjointSetUnion dsu(r * c);
+  auto& dsu = ws.dsu;
+  dsu.reset(r * c);
   int ncomps = r * c;
   for(int x = 0; x < r; ++x) {
     for(int y = 0; y < c; ++y) {
       int a = x * c + y;
-      for(auto z : adj[x][y]) {
-        int nx = z.first, ny = z.second;
-        int b = nx * c + ny;
+      for(int i = 0; i < 4; ++i) {
+        if(!(ws.adj[a] >> i & 1)) continue;
+        int b = (x + util::DIR_X[i]) * c + (y + util::DIR_Y[i]);
         if(dsu.unite(a, b)) {
           ncomps -= 1;
         }
@@ -149,45 +341,78 @@ std::vector<std::pair<int, int>> Prim<distance_type, grid_type>::run(const Dista
   if (ncomps != 1) {
     throw std::runtime_error(std::format(
       "Connectivity Error: Graph is disconnected.\n"
-      "Expected 1 component, found {}.", 
+      "Expected 1 component, found {}.",
       ncomps
     ));
   }
-  std::vector<std::pair<int, int>> pixel_order;
+}
+
+template<typename distance_type, typename grid_type>
+template<typename Visitor>
+void Prim<distance_type, grid_type>::walk(Visitor&& visit) {
   std::pair<int, int> cur = {0, 0};
-  std::vector is_visited(r, std::vector<bool>(c, false));
-  
+  auto& is_visited = ws.is_visited;
+  is_visited.assign(r * c, false);
+  size_t visited_count = 0;
+  int direction = -1;
+  // Neighbours are tried in (row, col) order: up, left, right, down
+  constexpr int WALK_ORDER[4] = {3, 2, 0, 1};
+
   do {
-    is_visited[cur.first][cur.second] = true;
-    pixel_order.emplace_back(cur);
-    for(auto nxt : adj[cur.first][cur.second]) {
-      if(is_visited[nxt.first][nxt.second]) continue;
+    is_visited[cur.first * c + cur.second] = true;
+    visited_count += 1;
+    visit(cur, direction);
+    for(int i : WALK_ORDER) {
+      if(!(ws.adj[cur.first * c + cur.second] >> i & 1)) continue;
+      std::pair<int, int> nxt = {cur.first + util::DIR_X[i], cur.second + util::DIR_Y[i]};
+      if(is_visited[nxt.first * c + nxt.second]) continue;
       cur = nxt;
+      direction = i;
       break;
     }
-  } while(!is_visited[cur.first][cur.second]);
+  } while(!is_visited[cur.first * c + cur.second]);
 
-  if (pixel_order.size() != (size_t)(r * c)) {
+  if (visited_count != (size_t)(r * c)) {
     throw std::runtime_error(std::format(
       "Path Integrity Error: Space-filling curve is incomplete.\n"
-      "Expected {} pixels, but traversed {}.", 
-      r * c, pixel_order.size()
+      "Expected {} pixels, but traversed {}.",
+      r * c, visited_count
     ));
   }
-  return pixel_order;
 }
 
 template<typename distance_type, typename grid_type>
 void Prim<distance_type, grid_type>::add_edge(std::pair<int, int> a, std::pair<int, int> b) {
-  this->adj[a.first][a.second].emplace(b);
-  this->adj[b.first][b.second].emplace(a);
+  ws.adj[a.first * c + a.second] |= uint8_t(1 << util::get_direction(a, b));
+  ws.adj[b.first * c + b.second] |= uint8_t(1 << util::get_direction(b, a));
+}
+
+template<typename distance_type, typename grid_type>
+void Prim<distance_type, grid_type>::remove_edge(std::pair<int, int> a, std::pair<int, int> b) {
+  ws.adj[a.first * c + a.second] &= uint8_t(~(1 << util::get_direction(a, b)));
+  ws.adj[b.first * c + b.second] &= uint8_t(~(1 << util::get_direction(b, a)));
+}
+
+template<typename distance_type, typename grid_type>
+void Prim<distance_type, grid_type>::merge(std::pair<int, int> id_par, std::pair<int, int> id) {
+  // Merges commute: each pair of adjacent circuits only touches its own facing edges
+  const auto& topology = util::get_merge_topology(id_par, id);
+  for(const auto& edge : topology.removed) {
+    auto [u, v] = edge.at(id_par);
+    remove_edge(u, v);
+  }
+  for(const auto& edge : topology.added) {
+    auto [u, v] = edge.at(id_par);
+    add_edge(u, v);
+  }
 }
 
 template<typename distance_type, typename grid_type>
 void Prim<distance_type, grid_type>::initial_adj() {
+  ws.adj.assign(r * c, 0);
   for(int i = 0; i < node_r; ++i) {
     for(int j = 0; j < node_c; ++j) {
-      auto cycle = util::get_node_cycle({i, j}); 
+      auto cycle = util::get_node_cycle({i, j});
       for(int e = 0; e < 4; ++e) {
         int ne = e + 1 == 4 ? 0 : e + 1;
         add_edge(cycle[e], cycle[ne]);
@@ -0,0 +1,226 @@
+#ifndef PYRAMID_H
+#define PYRAMID_H
+
+#include <vector>
+#include <utility>
+#include <limits>
+#include <tuple>
+#include <algorithm>
+
+#include "prim.hpp"
+#include "data_driven.hpp"
+
+/**
+ * @namespace pyramid
+ * @brief A namespace with the coarse-to-fine construction of data driven curves.
+ *
+ * The node grid of level k + 1 is the node grid of level k downsampled by 2,
+ * so every coarse node is a cell of 2 x 2 fine nodes (the last row and column
+ * of cells also absorb an odd leftover). The minimum spanning tree is only
+ * computed globally on the coarsest level. Each finer level then refines it:
+ *  - every coarse tree edge becomes the cheapest fine edge crossing between
+ *    the two cells, in the same direction;
+ *  - the nodes of every cell are joined by Prim's algorithm restricted to the
+ *    cell, grown from the node the crossing edge enters.
+ * The result is a spanning tree of the full resolution node grid that follows
+ * the coarse ordering, turned into a curve by Prim::run.
+ */
+namespace pyramid {
+
+template<typename T>
+using Grid = std::vector<std::vector<std::vector<T>>>;
+
+/**
+ * @brief Averages the 2 x 2 pixels of every node of fine into one pixel of coarse.
+ * @details coarse is resized in place, so a buffer of the same shape is reused.
+ * @param rows, cols The pixel shape of coarse, at most the node shape of fine.
+ */
+template<typename distance_type, typename grid_type>
+void downsample(const Grid<grid_type>& fine, Grid<distance_type>& coarse, int rows, int cols) {
+  size_t channels = fine[0][0].size();
+  coarse.resize(rows);
+  for(auto& row : coarse) {
+    row.resize(cols);
+    for(auto& pixel : row) {
+      pixel.resize(channels);
+    }
+  }
+  for(int x = 0; x < rows; ++x) {
+    for(int y = 0; y < cols; ++y) {
+      for(size_t k = 0; k < channels; ++k) {
+        distance_type sum = static_cast<distance_type>(fine[2 * x][2 * y][k])
+          + static_cast<distance_type>(fine[2 * x][2 * y + 1][k])
+          + static_cast<distance_type>(fine[2 * x + 1][2 * y][k])
+          + static_cast<distance_type>(fine[2 * x + 1][2 * y + 1][k]);
+        coarse[x][y][k] = sum / 4;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Refines a spanning tree of the coarse node grid into one of the fine node grid.
+ *
+ * @param coarse_parent The parent of each coarse node, -1 for the root.
+ * @param coarse_shape, fine_shape Node grid shapes, coarse_shape is fine_shape / 2.
+ * @param dist_calc The distance of the fine level.
+ * @return The parent of each fine node, -1 for the root.
+ */
+template<typename distance_type, typename grid_type>
+std::vector<int> refine(const std::vector<int>& coarse_parent, std::pair<int, int> coarse_shape, std::pair<int, int> fine_shape, const Distance<distance_type, grid_type>& dist_calc) {
+  auto [m_r, m_c] = coarse_shape;
+  auto [n_r, n_c] = fine_shape;
+  auto cell_lo = [](int a) { return 2 * a; };
+  auto row_hi = [&](int a) { return a == m_r - 1 ? n_r : 2 * a + 2; };
+  auto col_hi = [&](int b) { return b == m_c - 1 ? n_c : 2 * b + 2; };
+
+  using iii = std::tuple<distance_type, int, int>;
+  std::vector<int> parent(static_cast<size_t>(n_r) * n_c, -1);
+  std::vector<distance_type> min_w(static_cast<size_t>(n_r) * n_c, std::numeric_limits<distance_type>::max());
+  std::vector<uint8_t> is_selected(static_cast<size_t>(n_r) * n_c, false);
+
+  for(int a = 0; a < m_r; ++a) {
+    for(int b = 0; b < m_c; ++b) {
+      int r0 = cell_lo(a), r1 = row_hi(a), c0 = cell_lo(b), c1 = col_hi(b);
+      std::pair<int, int> entry = {r0, c0};
+
+      int cell_parent = coarse_parent[a * m_c + b];
+      if(cell_parent != -1) {
+        // Cheapest fine edge from the parent cell into this one, ties broken as in Prim
+        int pa = cell_parent / m_c, pb = cell_parent % m_c;
+        iii best = {std::numeric_limits<distance_type>::max(), n_r, n_c};
+        std::pair<int, int> best_from = {-1, -1};
+        auto consider = [&](std::pair<int, int> u, std::pair<int, int> v) {
+          iii candidate = {dist_calc.get_distance(u, v), v.first, v.second};
+          if(candidate < best) {
+            best = candidate;
+            best_from = u;
+          }
+        };
+        if(pa != a) {
+          int ux = pa < a ? row_hi(pa) - 1 : cell_lo(pa), vx = pa < a ? r0 : r1 - 1;
+          for(int y = c0; y < c1; ++y) consider({ux, y}, {vx, y});
+        } else {
+          int uy = pb < b ? col_hi(pb) - 1 : cell_lo(pb), vy = pb < b ? c0 : c1 - 1;
+          for(int x = r0; x < r1; ++x) consider({x, uy}, {x, vy});
+        }
+        entry = {std::get<1>(best), std::get<2>(best)};
+        parent[entry.first * n_c + entry.second] = best_from.first * n_c + best_from.second;
+      }
+
+      // Prim's algorithm restricted to the cell, which has at most 3 x 3 nodes
+      min_w[entry.first * n_c + entry.second] = 0;
+      for(int remaining = (r1 - r0) * (c1 - c0); remaining > 0; --remaining) {
+        iii best = {std::numeric_limits<distance_type>::max(), n_r, n_c};
+        for(int x = r0; x < r1; ++x) {
+          for(int y = c0; y < c1; ++y) {
+            int node = x * n_c + y;
+            if(!is_selected[node] && iii{min_w[node], x, y} < best) {
+              best = {min_w[node], x, y};
+            }
+          }
+        }
+        auto [d, id_x, id_y] = best;
+        int node = id_x * n_c + id_y;
+        is_selected[node] = true;
+        for(int i = 0; i < 4; ++i) {
+          int id_nx = id_x + util::DIR_X[i], id_ny = id_y + util::DIR_Y[i];
+          if(id_nx < r0 || id_ny < c0 || id_nx >= r1 || id_ny >= c1) continue;
+          int next = id_nx * n_c + id_ny;
+          if(is_selected[next]) continue;
+
+          auto cost = dist_calc.get_distance({id_x, id_y}, {id_nx, id_ny});
+          if(min_w[next] > cost) {
+            min_w[next] = cost;
+            parent[next] = node;
+          }
+        }
+      }
+    }
+  }
+  return parent;
+}
+
+/**
+ * @brief Buffers of PyramidPrim kept between runs, next to the full resolution PrimWorkspace.
+ */
+template<typename distance_type>
+struct PyramidWorkspace {
+  PrimWorkspace<distance_type> coarse;      // Prim runner of the coarsest level
+  std::vector<Grid<distance_type>> images; // Downsampled image of each coarse level
+};
+
+/**
+ * @brief Builds a data driven curve coarse to fine.
+ * @details levels = 0 is exactly Prim's algorithm. Every extra level halves the
+ * node grid the global minimum spanning tree runs on, down to a 1 x 1 node grid.
+ * BLOCK is measured in nodes, so it is halved at every level as well.
+ *
+ * @tparam distance_type the numerical type for distances, float or double.
+ * @tparam grid_type the numerical type of each color channel of the input.
+ */
+template<typename distance_type, typename grid_type>
+class PyramidPrim {
+public:
+  /**
+   * @param r, c The pixel grid shape.
+   * @param levels Number of coarse levels above the full resolution one.
+   * @param workspace Buffers for the full resolution Prim runner.
+   * @param pyramid_workspace Buffers for the coarse levels.
+   */
+  PyramidPrim(int r, int c, int levels, PrimWorkspace<distance_type>& workspace, PyramidWorkspace<distance_type>& pyramid_workspace) :
+    r { r },
+    c { c },
+    ws { workspace },
+    pws { pyramid_workspace }
+  {
+    shapes.emplace_back(r / 2, c / 2);
+    while(static_cast<int>(shapes.size()) <= levels && shapes.back().first >= 2 && shapes.back().second >= 2) {
+      shapes.emplace_back(shapes.back().first / 2, shapes.back().second / 2);
+    }
+  }
+
+  /**
+   * @brief Number of coarse levels actually used, levels is clamped by the grid shape.
+   */
+  int get_levels() const { return static_cast<int>(shapes.size()) - 1; }
+
+  std::vector<std::pair<int, int>> run(const Grid<grid_type>& grid, distance_type ALPHA, int BLOCK);
+
+private:
+  int r, c;
+  PrimWorkspace<distance_type>& ws;
+  PyramidWorkspace<distance_type>& pws;
+  std::vector<std::pair<int, int>> shapes; // Node grid shape of each level
+};
+
+template<typename distance_type, typename grid_type>
+std::vector<std::pair<int, int>> PyramidPrim<distance_type, grid_type>::run(const Grid<grid_type>& grid, distance_type ALPHA, int BLOCK) {
+  int levels = get_levels();
+  if(levels == 0) {
+    return Prim<distance_type, grid_type>(r, c, ws).run(DataDrivenDistance<distance_type, grid_type>(grid, ALPHA, BLOCK));
+  }
+  auto level_block = [&](int k) { return std::max(1, BLOCK >> k); };
+
+  // Level k has pixel shape 2 * shapes[k], read from the node grid of level k - 1
+  auto& images = pws.images;
+  images.resize(levels);
+  downsample<distance_type>(grid, images[0], 2 * shapes[1].first, 2 * shapes[1].second);
+  for(int k = 2; k <= levels; ++k) {
+    downsample<distance_type>(images[k - 2], images[k - 1], 2 * shapes[k].first, 2 * shapes[k].second);
+  }
+
+  auto [top_r, top_c] = shapes[levels];
+  auto parent = Prim<distance_type, distance_type>(2 * top_r, 2 * top_c, pws.coarse).spanning_tree(
+    DataDrivenDistance<distance_type, distance_type>(images[levels - 1], ALPHA, level_block(levels))
+  );
+  for(int k = levels - 1; k >= 1; --k) {
+    parent = refine(parent, shapes[k + 1], shapes[k], DataDrivenDistance<distance_type, distance_type>(images[k - 1], ALPHA, level_block(k)));
+  }
+  parent = refine(parent, shapes[1], shapes[0], DataDrivenDistance<distance_type, grid_type>(grid, ALPHA, BLOCK));
+  return Prim<distance_type, grid_type>(r, c, ws).run(parent);
+}
+
+}
+
+#endif // !PYRAMID_H
@@ -0,0 +1,137 @@
+#ifndef QUANTIZED_DATA_DRIVEN_H
+#define QUANTIZED_DATA_DRIVEN_H
+#include "distance.hpp"
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * @brief Integer implementation of the Data Driven distance for quantized
+ * (uint8/uint16) grids.
+ * @details The pixel L1 costs are exact integers for quantized inputs, so the
+ * adjacency term is evaluated in int32. Only the ALPHA-weighted block term is
+ * fractional: it is precomputed once into a BLOCK x BLOCK fixed-point table,
+ * which can be shared by every distance built with the same ALPHA and BLOCK.
+ * The returned distance is a fixed-point value scaled by FIXED_POINT_SCALE.
+ *
+ * Paths are identical to DataDrivenDistance<double, grid_type> whenever the
+ * block term cannot reorder near-ties, in particular for ALPHA = 0 and ALPHA = 1.
+ * For other ALPHA values the weights are rounded to 1 / FIXED_POINT_SCALE.
+ *
+ * The keys are int64, as wide as the double ones, so Prim's heap entries are no
+ * smaller than in the double path: the gain only comes from the integer
+ * arithmetic of the costs.
+ *
+ * @tparam grid_type the integral type of each color channel on each position
+ * of the grid. The int32 adjacency term adds up to 5 pixel costs of channels *
+ * max value each, so at most MAX_CHANNELS channels are accepted (6553 for
+ * uint16); larger grids throw instead of overflowing.
+ */
+template<typename grid_type>
+class QuantizedDataDrivenDistance : public Distance<int64_t, grid_type> {
+  static_assert(std::is_integral_v<grid_type>, "QuantizedDataDrivenDistance needs an integral grid_type");
+public:
+  static constexpr int64_t FIXED_POINT_SCALE = int64_t{1} << 16;
+  static constexpr int64_t MAX_CHANNELS = std::numeric_limits<int32_t>::max() / (5 * static_cast<int64_t>(std::numeric_limits<grid_type>::max()));
+
+  using BlockTable = std::vector<std::vector<int64_t>>; // ALPHA * block_edge_cost, in fixed-point
+
+  /**
+   * @brief Precomputes the block term of every position of a BLOCK x BLOCK block.
+   */
+  static std::shared_ptr<const BlockTable> make_block_table(double ALPHA, int BLOCK) {
+    auto table = std::make_shared<BlockTable>(BLOCK, std::vector<int64_t>(BLOCK));
+    double center = (BLOCK - 1) / 2.0;
+    for(int x = 0; x < BLOCK; ++x) {
+      for(int y = 0; y < BLOCK; ++y) {
+        double dx = x - center, dy = y - center;
+        (*table)[x][y] = std::llround(ALPHA * std::sqrt(dx * dx + dy * dy) * FIXED_POINT_SCALE);
+      }
+    }
+    return table;
+  }
+
+  /**
+   * @brief Constructs the quantized Data Driven Distance calculator.
+   * @param grid A const reference to the 3D grid data [x][y][channel].
+   * @param ALPHA An auxiliary weight value between 0-1 for distance calculation
+   * @param BLOCK The small circuits are divided into blocks of size BLOCK x BLOCK
+   */
+  QuantizedDataDrivenDistance(const std::vector<std::vector<std::vector<grid_type>>>& grid, double ALPHA, int BLOCK) :
+    QuantizedDataDrivenDistance(grid, ALPHA, BLOCK, make_block_table(ALPHA, BLOCK)) {}
+
+  /**
+   * @brief Same as above, reusing a table from make_block_table(ALPHA, BLOCK).
+   */
+  QuantizedDataDrivenDistance(const std::vector<std::vector<std::vector<grid_type>>>& grid, double ALPHA, int BLOCK, std::shared_ptr<const BlockTable> block_table) :
+    Distance<int64_t, grid_type>{grid},
+    BLOCK { BLOCK },
+    adj_weight { std::llround((1 - ALPHA) * FIXED_POINT_SCALE) },
+    block_table { std::move(block_table) }
+  {
+    if(!grid.empty() && !grid[0].empty() && static_cast<int64_t>(grid[0][0].size()) > MAX_CHANNELS) {
+      throw std::runtime_error(std::format(
+        "Integer precision supports at most {} channels of this type, found = {}", MAX_CHANNELS, grid[0][0].size()
+      ));
+    }
+  }
+  /**
+   * @brief Function for calculating edge distances
+   * @details the positions of the initial small circuits are passed as parameters.
+   * During the prim's algorithm execution, id_a belong to a expanding tree, while
+   * id_b is an unvisited node.
+   * @param id_a The [x, y] coordinates of the node in the tree.
+   * @param id_b The [x, y] coordinates of the unvisited node.
+   * @return The calculated cost in fixed-point.
+   */
+  int64_t get_distance(std::pair<int, int> id_a, std::pair<int, int> id_b) const override;
+private:
+  int BLOCK;
+  int64_t adj_weight;
+  std::shared_ptr<const BlockTable> block_table;
+  int32_t adj_edge_cost(std::pair<int, int> id_a, std::pair<int, int> id_b) const;
+  int32_t pixel_edge_cost(std::pair<int, int> a, std::pair<int, int> b) const;
+};
+
+template<typename grid_type>
+int32_t QuantizedDataDrivenDistance<grid_type>::pixel_edge_cost(std::pair<int, int> a, std::pair<int, int> b) const {
+  int32_t pixel_cost = 0;
+  auto& ra = this->grid[a.first][a.second];
+  auto& rb = this->grid[b.first][b.second];
+
+  for(size_t i = 0, len = ra.size(); i < len; ++i) {
+    int32_t diff = static_cast<int32_t>(ra[i]) - static_cast<int32_t>(rb[i]);
+    pixel_cost += diff < 0 ? -diff : diff;
+  }
+  return pixel_cost;
+}
+
+template<typename grid_type>
+int32_t QuantizedDataDrivenDistance<grid_type>::adj_edge_cost(std::pair<int, int> id_a, std::pair<int, int> id_b) const {
+  int32_t cost = 0;
+  const auto& topology = util::get_merge_topology(id_a, id_b);
+  for(const auto& edge : topology.kept) {
+    auto [u, v] = edge.at(id_a);
+    cost += pixel_edge_cost(u, v);
+  }
+  for(const auto& edge : topology.removed) {
+    auto [u, v] = edge.at(id_a);
+    cost -= pixel_edge_cost(u, v);
+  }
+  for(const auto& edge : topology.added) {
+    auto [u, v] = edge.at(id_a);
+    cost += pixel_edge_cost(u, v);
+  }
+  return cost;
+}
+
+template<typename grid_type>
+int64_t QuantizedDataDrivenDistance<grid_type>::get_distance(std::pair<int, int> id_a, std::pair<int, int> id_b) const {
+  return adj_weight * adj_edge_cost(id_a, id_b) + (*block_table)[id_b.first % BLOCK][id_b.second % BLOCK];
+}
+
+#endif // !QUANTIZED_DATA_DRIVEN_H
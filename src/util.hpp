@@ -1,9 +1,8 @@
 #ifndef UTIL_HPP
 #define UTIL_HPP
 
-#include <vector>
+#include <array>
 #include <utility> // For std::pair
-#include <set>     // For std::set
 
 /**
  * @namespace util
@@ -17,22 +16,36 @@ inline constexpr int DIR_Y[4] = {+1, +0, -1, -0};
 
 /**
  * @brief Calculates the 2D cross product of two vectors (pairs).
- * 
+ *
  * In this application, it's a utility function used to calculate the cross
  * between unit vectors.
  */
-int cross(std::pair<int, int> u, std::pair<int, int> v) {
+constexpr int cross(std::pair<int, int> u, std::pair<int, int> v) {
   return u.first * v.second - u.second * v.first;
 }
 
+/**
+ * @brief Gets the index i such that (DIR_X[i], DIR_Y[i]) goes from a to b.
+ * @details a and b must be 4-neighbours, either pixels or node ids.
+ */
+constexpr int get_direction(std::pair<int, int> a, std::pair<int, int> b) {
+  int dx = b.first - a.first, dy = b.second - a.second;
+  for(int i = 0; i < 4; ++i) {
+    if(DIR_X[i] == dx && DIR_Y[i] == dy) {
+      return i;
+    }
+  }
+  return -1;
+}
+
 /**
  * @brief Gets the 4 corner coordinates for a node ID.
  */
-std::vector<std::pair<int, int>> get_node_cycle(std::pair<int, int> id) {
+constexpr std::array<std::pair<int, int>, 4> get_node_cycle(std::pair<int, int> id) {
   int x = id.first * 2, y = id.second * 2;
-  std::vector<std::pair<int, int>> cycle;
+  std::array<std::pair<int, int>, 4> cycle{};
   for(int i = 0; i < 4; ++i) {
-    cycle.emplace_back(x, y);
+    cycle[i] = {x, y};
     x += DIR_X[i];
     y += DIR_Y[i];
   }
@@ -40,57 +53,81 @@ std::vector<std::pair<int, int>> get_node_cycle(std::pair<int, int> id) {
 }
 
 /**
- * @brief Calculates edges to be removed when merging two nodes.
+ * @brief A pixel edge (a, b) stored as offsets from the top-left pixel of id_a.
+ */
+struct EdgeOffset {
+  int ax, ay, bx, by;
+
+  constexpr std::pair<std::pair<int, int>, std::pair<int, int>> at(std::pair<int, int> id_a) const {
+    int x = id_a.first * 2, y = id_a.second * 2;
+    return {{x + ax, y + ay}, {x + bx, y + by}};
+  }
+};
+
+/**
+ * @brief Pixel edges touched when merging the circuit id_b into the circuit id_a.
+ * @details Since there are only four merge directions, these are fixed offsets
+ * and are computed once at compile time.
+ */
+struct MergeTopology {
+  EdgeOffset kept[3];    // edges of id_b that survive the merge (parallel or clockwise)
+  EdgeOffset removed[2]; // edges of id_b and id_a that are removed
+  EdgeOffset added[2];   // edges that connect id_a and id_b
+};
+
+/**
+ * @brief Builds the merge topology for id_b = id_a + (DIR_X[d], DIR_Y[d]).
  */
-std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> get_removed_edges(std::pair<int, int> id_a, std::pair<int, int> id_b) {
-  auto cycle_b = get_node_cycle(id_b);
-  std::pair<int, int> dir_ab = {id_b.first - id_a.first, id_b.second - id_a.second};
-  std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> rem;
+constexpr MergeTopology make_merge_topology(int d) {
+  MergeTopology topology{};
+  std::pair<int, int> dir_ab = {DIR_X[d], DIR_Y[d]};
+  auto cycle_a = get_node_cycle({0, 0});
+  auto cycle_b = get_node_cycle(dir_ab);
+  int kept = 0, removed = 0, added = 0;
+
   for(int e = 0; e < 4; ++e) {
     int ne = e + 1 == 4 ? 0 : e + 1;
     std::pair<int, int> dir(cycle_b[ne].first - cycle_b[e].first, cycle_b[ne].second - cycle_b[e].second);
-    auto u = cross(dir_ab, dir);
-
-    if(u <= 0) { // parallel or clockwise 
-      continue;
-    } 
-    // counterclockwise
-    rem.emplace_back(cycle_b[e], cycle_b[ne]);
+    EdgeOffset edge = {cycle_b[e].first, cycle_b[e].second, cycle_b[ne].first, cycle_b[ne].second};
+    if(cross(dir_ab, dir) <= 0) { // parallel or clockwise
+      topology.kept[kept++] = edge;
+    } else { // counterclockwise
+      topology.removed[removed++] = edge;
+    }
   }
-
-  auto cycle_a = get_node_cycle(id_a);
   for(int e = 0; e < 4; ++e) {
     int ne = e + 1 == 4 ? 0 : e + 1;
     std::pair<int, int> dir(cycle_a[ne].first - cycle_a[e].first, cycle_a[ne].second - cycle_a[e].second);
-    auto u = cross(dir_ab, dir);
-    if(u == -1) { // clockwise
-      rem.emplace_back(cycle_a[e], cycle_a[ne]);
+    if(cross(dir_ab, dir) == -1) { // clockwise
+      topology.removed[removed++] = {cycle_a[e].first, cycle_a[e].second, cycle_a[ne].first, cycle_a[ne].second};
+    }
+  }
+  for(auto u : cycle_a) {
+    std::pair<int, int> v = {u.first + dir_ab.first, u.second + dir_ab.second};
+    for(auto w : cycle_b) {
+      if(w == v) { // from one group to another
+        topology.added[added++] = {u.first, u.second, v.first, v.second};
+      }
     }
   }
-  return rem;
+  return topology;
 }
 
 /**
- * @brief Calculates edges to be added when merging two nodes.
+ * @brief Merge topology for each of the four directions, indexed like DIR_X/DIR_Y.
  */
-std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> get_added_edges(std::pair<int, int> id_a, std::pair<int, int> id_b) {
-  std::pair<int, int> dir_ab = {id_b.first - id_a.first, id_b.second - id_a.second};
-  std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> add;
-  std::set<std::pair<int, int>> cycle_b;
-  for(auto x : get_node_cycle(id_b)) {
-    cycle_b.insert(x);
-  }
-  auto cycle_a = get_node_cycle(id_a);
-  for(auto u : cycle_a) {
-    auto v = u;
-    v.first += dir_ab.first;
-    v.second += dir_ab.second;
+inline constexpr MergeTopology MERGE_TOPOLOGY[4] = {
+  make_merge_topology(0),
+  make_merge_topology(1),
+  make_merge_topology(2),
+  make_merge_topology(3)
+};
 
-    if(cycle_b.count(v)) { // from one group to another
-      add.emplace_back(u, v);
-    }
-  }
-  return add;
+/**
+ * @brief Gets the merge topology used when merging id_b into id_a.
+ */
+constexpr const MergeTopology& get_merge_topology(std::pair<int, int> id_a, std::pair<int, int> id_b) {
+  return MERGE_TOPOLOGY[get_direction(id_a, id_b)];
 }
 
 } // namespace util
@@ -0,0 +1,102 @@
+// Checks that the curve construction hot path does not allocate once its
+// buffers are warm: DataDrivenDistance::get_distance never allocates, and a
+// workspace-backed Prim::run allocates nothing after the first run.
+//
+// Build and run from the repository root:
+//   g++ -std=c++20 -O2 -Wall -Isrc tests/test_allocations.cpp -o test_allocations && ./test_allocations
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "data_driven.hpp"
+#include "prim.hpp"
+
+static size_t allocation_count = 0;
+
+// Every form of the global operators is replaced and goes through this one
+// malloc/free pair. They are kept out of line, so the compiler never pairs an
+// inlined free with a new expression (-Wmismatched-new-delete).
+[[gnu::noinline]] static void* counted_allocate(size_t size, size_t alignment) {
+  allocation_count += 1;
+  size = size == 0 ? 1 : size;
+  if(alignment > alignof(std::max_align_t)) {
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+  }
+  return std::malloc(size);
+}
+[[gnu::noinline]] static void counted_release(void* p) { std::free(p); }
+
+static void* counted_allocate_or_throw(size_t size, size_t alignment) {
+  if(void* p = counted_allocate(size, alignment)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size) { return counted_allocate_or_throw(size, 0); }
+void* operator new[](size_t size) { return counted_allocate_or_throw(size, 0); }
+void* operator new(size_t size, std::align_val_t a) { return counted_allocate_or_throw(size, static_cast<size_t>(a)); }
+void* operator new[](size_t size, std::align_val_t a) { return counted_allocate_or_throw(size, static_cast<size_t>(a)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_allocate(size, 0); }
+void* operator new(size_t size, std::align_val_t a, const std::nothrow_t&) noexcept { return counted_allocate(size, static_cast<size_t>(a)); }
+void* operator new[](size_t size, std::align_val_t a, const std::nothrow_t&) noexcept { return counted_allocate(size, static_cast<size_t>(a)); }
+
+void operator delete(void* p) noexcept { counted_release(p); }
+void operator delete[](void* p) noexcept { counted_release(p); }
+void operator delete(void* p, size_t) noexcept { counted_release(p); }
+void operator delete[](void* p, size_t) noexcept { counted_release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_release(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { counted_release(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { counted_release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_release(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_release(p); }
+
+static int failures = 0;
+volatile double distance_sink; // Keeps the get_distance calls alive
+
+static void check(bool condition, const char* what, size_t allocations) {
+  std::printf("%s %s (%zu allocations)\n", condition ? "PASS" : "FAIL", what, allocations);
+  failures += condition ? 0 : 1;
+}
+
+int main() {
+  std::mt19937 rng(3);
+  for(int size : {16, 64, 256}) {
+    std::vector<std::vector<std::vector<uint8_t>>> img(size, std::vector<std::vector<uint8_t>>(size, std::vector<uint8_t>(3)));
+    for(auto& row : img) for(auto& pixel : row) for(auto& value : pixel) value = static_cast<uint8_t>(rng());
+    std::printf("%dx%d\n", size, size);
+
+    DataDrivenDistance<double, uint8_t> distance(img, 0.3, 4);
+    size_t before = allocation_count;
+    double sink = 0;
+    for(int x = 0; x + 1 < size / 2; ++x) {
+      for(int y = 0; y + 1 < size / 2; ++y) {
+        sink += distance.get_distance({x, y}, {x + 1, y}) + distance.get_distance({x + 1, y}, {x, y});
+        sink += distance.get_distance({x, y}, {x, y + 1}) + distance.get_distance({x, y + 1}, {x, y});
+      }
+    }
+    distance_sink = sink;
+    check(allocation_count == before, "get_distance", allocation_count - before);
+
+    PrimWorkspace<double> workspace;
+    workspace.reserve(size, size);
+    std::vector<std::pair<int, int>> path, first_path;
+    Prim<double, uint8_t>(size, size, workspace).run(distance, path);
+    first_path = path;
+    for(int run = 0; run < 3; ++run) {
+      before = allocation_count;
+      Prim<double, uint8_t>(size, size, workspace).run(distance, path);
+      check(allocation_count == before, "Prim::run after the first run", allocation_count - before);
+    }
+    check(path == first_path && path.size() == static_cast<size_t>(size) * size, "Prim::run is repeatable", 0);
+  }
+  return failures == 0 ? 0 : 1;
+}
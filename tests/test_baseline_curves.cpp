@@ -0,0 +1,141 @@
+// Checks the baseline curves of baseline_curves.hpp on every shape up to 40 x 40:
+// each one visits every pixel exactly once; snake only moves to 4-neighbours;
+// Hilbert makes at most one diagonal step, none when its longer side is even,
+// and is the classic Hilbert curve on power of two squares; Morton follows the
+// bit-interleaved order. CurveEngine::compare is checked on a small image.
+//
+// Build and run from the repository root:
+//   g++ -std=c++20 -O2 -Isrc tests/test_baseline_curves.cpp -o test_baseline_curves && ./test_baseline_curves
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "baseline_curves.hpp"
+#include "curve_engine.hpp"
+
+using Path = std::vector<std::pair<int, int>>;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+  if(!condition) {
+    std::printf("FAIL %s\n", what.c_str());
+    failures += 1;
+  }
+}
+
+static bool is_permutation(const Path& path, int height, int width) {
+  if(path.size() != static_cast<size_t>(height) * width) {
+    return false;
+  }
+  std::vector<uint8_t> seen(path.size(), false);
+  for(auto [x, y] : path) {
+    if(x < 0 || y < 0 || x >= height || y >= width || seen[static_cast<size_t>(x) * width + y]) {
+      return false;
+    }
+    seen[static_cast<size_t>(x) * width + y] = true;
+  }
+  return true;
+}
+
+// Steps that do not move to a 4-neighbour, and whether all of them are diagonal
+static std::pair<int, bool> jumps(const Path& path) {
+  int count = 0;
+  bool diagonal = true;
+  for(size_t i = 1, len = path.size(); i < len; ++i) {
+    int dx = std::abs(path[i].first - path[i - 1].first), dy = std::abs(path[i].second - path[i - 1].second);
+    if(dx + dy != 1) {
+      count += 1;
+      diagonal = diagonal && dx == 1 && dy == 1;
+    }
+  }
+  return {count, diagonal};
+}
+
+// Classic Hilbert curve position d of an n x n grid, n a power of two
+static std::pair<int, int> hilbert_d2xy(int n, int d) {
+  int x = 0, y = 0;
+  for(int s = 1; s < n; s *= 2, d /= 4) {
+    int rx = 1 & (d / 2), ry = 1 & (d ^ rx);
+    if(ry == 0) {
+      if(rx == 1) {
+        x = s - 1 - x;
+        y = s - 1 - y;
+      }
+      std::swap(x, y);
+    }
+    x += s * rx;
+    y += s * ry;
+  }
+  return {x, y};
+}
+
+static int64_t morton_key(int x, int y) {
+  int64_t key = 0;
+  for(int b = 0; b < 16; ++b) {
+    key |= static_cast<int64_t>((y >> b) & 1) << (2 * b);
+    key |= static_cast<int64_t>((x >> b) & 1) << (2 * b + 1);
+  }
+  return key;
+}
+
+int main() {
+  for(int height = 1; height <= 40; ++height) {
+    for(int width = 1; width <= 40; ++width) {
+      auto shape = std::format(" {}x{}", height, width);
+
+      auto snake = baseline_curves::snake(height, width);
+      check(is_permutation(snake, height, width), "snake permutation" + shape);
+      check(jumps(snake).first == 0, "snake 4-connected" + shape);
+
+      auto hilbert = baseline_curves::hilbert(height, width);
+      check(is_permutation(hilbert, height, width), "hilbert permutation" + shape);
+      auto [count, diagonal] = jumps(hilbert);
+      check(count <= 1 && diagonal, "hilbert at most one diagonal step" + shape);
+      check(std::max(height, width) % 2 == 1 || count == 0, "hilbert 4-connected with an even longer side" + shape);
+
+      auto morton = baseline_curves::morton(height, width);
+      check(is_permutation(morton, height, width), "morton permutation" + shape);
+      check(std::is_sorted(morton.begin(), morton.end(), [](auto a, auto b) {
+        return morton_key(a.first, a.second) < morton_key(b.first, b.second);
+      }), "morton bit-interleaved order" + shape);
+    }
+  }
+
+  // On power of two squares, (row, col) of the generalized curve is (y, x) of the classic one
+  for(int n = 1; n <= 64; n *= 2) {
+    auto hilbert = baseline_curves::hilbert(n, n);
+    bool same = true;
+    for(int d = 0; d < n * n; ++d) {
+      auto [x, y] = hilbert_d2xy(n, d);
+      same = same && hilbert[d] == std::make_pair(y, x);
+    }
+    check(same, std::format("hilbert is the classic curve on {}x{}", n, n));
+  }
+
+  check(baseline_curves::snake(0, 5).empty() && baseline_curves::hilbert(3, 0).empty() && baseline_curves::morton(0, 0).empty(), "empty shapes");
+
+  // compare builds every curve on the same image
+  std::mt19937 rng(7);
+  int height = 24, width = 36;
+  Image<uint8_t> img(height, std::vector<std::vector<uint8_t>>(width, std::vector<uint8_t>(2)));
+  for(auto& row : img) for(auto& pixel : row) for(auto& value : pixel) value = static_cast<uint8_t>(rng());
+  CurveEngine engine(height, width, 2);
+  auto comparison = engine.compare(img, 0.5, 4, "double");
+  std::vector<std::string> names;
+  for(const auto& curve : comparison) {
+    names.push_back(curve.name);
+    check(is_permutation(curve.path, height, width), "compare permutation " + curve.name);
+    check(curve.locality_score == metrics::locality_score(img, curve.path), "compare locality score " + curve.name);
+  }
+  check(comparison.size() == 4 && comparison[0].path == engine.build_curve(img, 0.5, 4, "double"), "compare data driven curve");
+  check(comparison.size() == 4 && comparison[1].path == baseline_curves::hilbert(height, width)
+    && comparison[2].path == baseline_curves::morton(height, width) && comparison[3].path == baseline_curves::snake(height, width), "compare baseline curves");
+
+  std::printf("%s\n", failures == 0 ? "PASS" : std::format("{} failures", failures).c_str());
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+"""Checks that decode_chain_code accepts any bytes-like object, contiguous or not.
+
+Run from the repository root after building the module (pip install .):
+    python tests/test_chain_code.py
+"""
+
+import data_driven_module
+
+
+def snake(height, width):
+    return [(x, y if x % 2 == 0 else width - 1 - y) for x in range(height) for y in range(width)]
+
+
+def check_decodes(data, path, what):
+    decoded = [tuple(pixel) for pixel in data_driven_module.decode_chain_code(data)]
+    assert decoded == path, f"{what}: decoded path differs"
+    print(f"PASS {what}")
+
+
+def main():
+    path = snake(6, 10)
+    data = data_driven_module.encode_chain_code(path, 6, 10, 4)
+
+    check_decodes(data, path, "bytes")
+    check_decodes(bytearray(data), path, "bytearray")
+    check_decodes(memoryview(data)[::1], path, "contiguous memoryview")
+
+    # Every other byte of a buffer holding each byte twice is a strided view of data
+    doubled = bytes(b for byte in data for b in (byte, 0xFF))
+    strided = memoryview(doubled)[::2]
+    assert not strided.contiguous
+    check_decodes(strided, path, "strided memoryview")
+
+    try:
+        import numpy as np
+    except ImportError:
+        print("SKIP numpy views, numpy is not installed")
+        return
+    array = np.frombuffer(data, dtype=np.uint8)
+    check_decodes(array, path, "numpy array")
+    check_decodes(np.repeat(array, 3)[::3], path, "sliced numpy array")
+    # Column of a 2D array: one byte every 4
+    check_decodes(np.stack([array] * 4, axis=1)[:, 2], path, "numpy column")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,135 @@
+// Checks CurveIndex and AnimationIndex against a brute-force scan of the curve:
+// query must return exactly the minimal sorted intervals of the positions inside
+// the rectangle, and bounds their hull. Data driven and Hilbert curves go
+// through the border scan of 4-connected curves, Z-order and shuffled curves
+// through the tile hierarchy.
+//
+// Build and run from the repository root:
+//   g++ -std=c++20 -O2 -Isrc tests/test_curve_index.cpp -o test_curve_index && ./test_curve_index
+
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "curve_engine.hpp"
+#include "curve_index.hpp"
+
+using Path = std::vector<std::pair<int, int>>;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+  if(!condition) {
+    std::printf("FAIL %s\n", what.c_str());
+    failures += 1;
+  }
+}
+
+static std::vector<CurveInterval> brute_force(const Path& path, int row_begin, int row_end, int col_begin, int col_end, int64_t offset) {
+  std::vector<CurveInterval> intervals;
+  for(size_t i = 0, len = path.size(); i < len; ++i) {
+    auto [x, y] = path[i];
+    if(x >= row_begin && x < row_end && y >= col_begin && y < col_end) {
+      intervals.push_back({offset + static_cast<int64_t>(i), offset + static_cast<int64_t>(i) + 1});
+    }
+  }
+  CurveIndex::normalize(intervals);
+  return intervals;
+}
+
+// Random rectangles, partly outside the grid to exercise the clamping
+static void check_queries(const std::string& name, const Path& path, int height, int width, std::mt19937& rng) {
+  CurveIndex index(path, height, width);
+  for(size_t i = 0, len = path.size(); i < len; ++i) {
+    if(index.rank(path[i].first, path[i].second) != static_cast<int32_t>(i)) {
+      check(false, name + " rank");
+      return;
+    }
+  }
+  for(int q = 0; q < 100; ++q) {
+    int row_begin = static_cast<int>(rng() % (height + 2)) - 1, row_end = static_cast<int>(rng() % (height + 2)) - 1;
+    int col_begin = static_cast<int>(rng() % (width + 2)) - 1, col_end = static_cast<int>(rng() % (width + 2)) - 1;
+    if(row_begin > row_end) std::swap(row_begin, row_end);
+    if(col_begin > col_end) std::swap(col_begin, col_end);
+    auto expected = brute_force(path, row_begin, row_end, col_begin, col_end, 0);
+    auto description = std::format("{} {}x{} query [{}, {}) x [{}, {})", name, height, width, row_begin, row_end, col_begin, col_end);
+    check(index.query(row_begin, row_end, col_begin, col_end) == expected, description);
+
+    CurveInterval hull = expected.empty() ? CurveInterval{0, 0} : CurveInterval{expected.front().first, expected.back().second};
+    check(index.bounds(row_begin, row_end, col_begin, col_end) == hull, description + " bounds");
+
+    auto shifted = brute_force(path, row_begin, row_end, col_begin, col_end, 1000);
+    check(index.query(row_begin, row_end, col_begin, col_end, 1000) == shifted, description + " offset");
+  }
+}
+
+int main() {
+  std::mt19937 rng(1);
+
+  // Data driven curves need even shapes
+  for(int t = 0; t < 20; ++t) {
+    int height = 2 + 2 * static_cast<int>(rng() % 20), width = 2 + 2 * static_cast<int>(rng() % 20);
+    Image<uint8_t> img(height, std::vector<std::vector<uint8_t>>(width, std::vector<uint8_t>(1)));
+    for(auto& row : img) for(auto& pixel : row) pixel[0] = static_cast<uint8_t>(rng());
+    CurveEngine engine(height, width, 1);
+    auto path = engine.build_curve(img, 0.5, 4, "double");
+    check_queries("data driven", path, height, width, rng);
+
+    // Every frame ends where the next one starts only if the rectangle holds both
+    std::vector<Path> paths = {path, path, path};
+    AnimationIndex animation(paths, height, width);
+    int64_t pixels = static_cast<int64_t>(height) * width;
+    check(animation.query(0, height, 0, width, 0, 3) == std::vector<CurveInterval>{{0, 3 * pixels}}, "animation full rectangle");
+    auto expected = brute_force(path, 1, height - 1, 0, width, pixels);
+    auto next = brute_force(path, 1, height - 1, 0, width, 2 * pixels);
+    expected.insert(expected.end(), next.begin(), next.end());
+    CurveIndex::normalize(expected);
+    check(animation.query(1, height - 1, 0, width, 1, 3) == expected, "animation frames [1, 3)");
+    check(animation.query(0, height, 0, width, -5, 10).size() == 1, "animation frame clamping");
+  }
+
+  for(int t = 0; t < 20; ++t) {
+    int height = 1 + static_cast<int>(rng() % 40), width = 1 + static_cast<int>(rng() % 40);
+    check_queries("hilbert", baseline_curves::hilbert(height, width), height, width, rng);
+    check_queries("morton", baseline_curves::morton(height, width), height, width, rng);
+    check_queries("snake", baseline_curves::snake(height, width), height, width, rng);
+
+    // Row major order with random nearby swaps, not 4-connected
+    auto shuffled = baseline_curves::snake(height, width);
+    for(size_t i = 0; i + 1 < shuffled.size(); i += 1 + rng() % 5) {
+      std::swap(shuffled[i], shuffled[std::min(shuffled.size() - 1, i + rng() % 3)]);
+    }
+    check_queries("shuffled", shuffled, height, width, rng);
+  }
+
+  // rank rejects pixels outside the image instead of reading out of bounds
+  CurveIndex small(baseline_curves::snake(3, 5), 3, 5);
+  for(auto [x, y] : std::vector<std::pair<int, int>>{{-1, 0}, {0, -1}, {3, 0}, {0, 5}, {3, 5}, {-1, -1}}) {
+    bool thrown = false;
+    try {
+      small.rank(x, y);
+    } catch(const std::out_of_range&) {
+      thrown = true;
+    }
+    check(thrown, std::format("rank({}, {}) outside a 3x5 image throws", x, y));
+  }
+  check(small.rank(0, 0) == 0 && small.rank(1, 4) == 5 && small.rank(2, 4) == 14, "rank at the image corners");
+
+  // Paths that are not a permutation of the grid are rejected
+  auto rejects = [](const Path& path, int height, int width) {
+    try {
+      CurveIndex index(path, height, width);
+    } catch(const std::runtime_error&) {
+      return true;
+    }
+    return false;
+  };
+  check(rejects({{0, 0}, {0, 1}, {1, 1}}, 2, 2), "rejects a short path");
+  check(rejects({{0, 0}, {0, 1}, {1, 1}, {0, 0}}, 2, 2), "rejects a repeated pixel");
+  check(rejects({{0, 0}, {0, 1}, {1, 1}, {2, 0}}, 2, 2), "rejects an out of range pixel");
+
+  std::printf("%s\n", failures == 0 ? "PASS" : std::format("{} failures", failures).c_str());
+  return failures == 0 ? 0 : 1;
+}
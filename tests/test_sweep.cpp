@@ -0,0 +1,93 @@
+// Checks CurveEngine::sweep against build_curve: on several threads, every
+// (ALPHA, BLOCK_SIZE) pair must give exactly the "double" path of a single-shot
+// build_curve, in the order of the parameters, with the requested locality
+// score. Runs on uint8, uint16 and float inputs, with more, fewer and as many
+// pairs as threads.
+//
+// Build and run from the repository root:
+//   g++ -std=c++20 -O2 -pthread -Isrc tests/test_sweep.cpp -o test_sweep && ./test_sweep
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "curve_engine.hpp"
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+  if(!condition) {
+    std::printf("FAIL %s\n", what.c_str());
+    failures += 1;
+  }
+}
+
+template<typename T>
+static Image<T> random_image(int height, int width, int channels, std::mt19937& rng) {
+  Image<T> img(height, std::vector<std::vector<T>>(width, std::vector<T>(channels)));
+  for(auto& row : img) for(auto& pixel : row) for(auto& value : pixel) {
+    if constexpr (std::is_integral_v<T>) {
+      value = static_cast<T>(rng());
+    } else {
+      value = static_cast<T>(rng() % 1000) / 7;
+    }
+  }
+  return img;
+}
+
+template<typename T>
+static void check_sweep(const std::string& name, const Image<T>& img, const std::vector<std::pair<double, int>>& parameters, int threads) {
+  int height = static_cast<int>(img.size()), width = static_cast<int>(img[0].size()), channels = static_cast<int>(img[0][0].size());
+  CurveEngine engine(height, width, channels), reference(height, width, channels);
+  auto description = std::format("{} {}x{}x{} {} threads", name, height, width, channels, threads);
+
+  for(bool with_locality : {false, true}) {
+    auto results = engine.sweep(img, parameters, with_locality, threads);
+    check(results.size() == parameters.size(), description + " result count");
+    for(size_t i = 0; i < results.size() && i < parameters.size(); ++i) {
+      auto [ALPHA, BLOCK_SIZE] = parameters[i];
+      auto pair = std::format("{} ALPHA = {} BLOCK_SIZE = {}", description, ALPHA, BLOCK_SIZE);
+      auto expected = reference.build_curve(img, ALPHA, BLOCK_SIZE, "double");
+      check(results[i].ALPHA == ALPHA && results[i].BLOCK_SIZE == BLOCK_SIZE, pair + " parameters");
+      check(results[i].path == expected, pair + " path");
+      if(with_locality) {
+        check(results[i].locality_score == metrics::locality_score(img, expected), pair + " locality score");
+      } else {
+        check(std::isnan(results[i].locality_score), pair + " locality score not requested");
+      }
+    }
+  }
+}
+
+int main() {
+  std::mt19937 rng(3);
+  std::vector<std::pair<double, int>> parameters;
+  for(double ALPHA : {0.0, 0.25, 0.5, 1.0, 2.0}) {
+    for(int BLOCK_SIZE : {1, 2, 4, 8}) {
+      parameters.push_back({ALPHA, BLOCK_SIZE});
+    }
+  }
+  // Repeated pairs are built independently
+  parameters.push_back({0.5, 4});
+
+  for(int threads : {2, 4, 7}) {
+    check_sweep("uint8", random_image<uint8_t>(24, 32, 3, rng), parameters, threads);
+    check_sweep("uint16", random_image<uint16_t>(18, 14, 1, rng), parameters, threads);
+    check_sweep("float", random_image<float>(16, 20, 2, rng), parameters, threads);
+  }
+  // As many threads as pairs, and more threads than pairs
+  auto img = random_image<uint8_t>(20, 20, 1, rng);
+  std::vector<std::pair<double, int>> few = {{0.5, 2}, {1.0, 4}, {0.0, 8}};
+  check_sweep("uint8", img, few, 3);
+  check_sweep("uint8", img, few, 16);
+  // The hardware concurrency
+  check_sweep("uint8", img, parameters, 0);
+
+  CurveEngine engine(20, 20, 1);
+  check(engine.sweep(img, {}, true, 4).empty(), "empty sweep");
+
+  std::printf("%s\n", failures == 0 ? "PASS" : std::format("{} failures", failures).c_str());
+  return failures == 0 ? 0 : 1;
+}